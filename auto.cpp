@@ -13,222 +13,6 @@
 #include <QMutexLocker>
 #include <algorithm>
 
-// TrainingTask的run方法实现
-void TrainingTask::run() {
-    // 模拟多次游戏并计算平均分数
-    int totalScore = 0;
-    Auto autoPlayer;
-
-    try {
-        // 初始化位棋盘表格 - 确保在开始模拟前初始化
-        autoPlayer.initTables();
-
-        // 复制回调函数，避免捕获this
-        auto progressCallbackCopy = progressCallback;
-        auto finalCallbackCopy    = finalCallback;
-        int simulationsCopy       = simulations;
-
-        for (int i = 0; i < simulations; ++i) {
-            int gameScore  = autoPlayer.simulateFullGame(params);
-            totalScore    += gameScore;
-
-            // 如果提供了进度回调，则在每次模拟后调用
-            if (progressCallbackCopy) {
-                // 计算当前平均分数
-                int currentAvgScore = totalScore / (i + 1);
-                // 使用QMetaObject::invokeMethod确保回调在主线程中执行
-                QMetaObject::invokeMethod(
-                    QApplication::instance(),
-                    [progressCallbackCopy, i, currentAvgScore, simulationsCopy]() {
-                        if (progressCallbackCopy) {
-                            progressCallbackCopy(i + 1, simulationsCopy, currentAvgScore);
-                        }
-                    },
-                    Qt::QueuedConnection);
-            }
-        }
-
-        int avgScore = totalScore / simulations;
-
-        // 调用最终回调函数返回分数 - 确保在主线程中执行
-        QMetaObject::invokeMethod(
-            QApplication::instance(),
-            [finalCallbackCopy, avgScore]() {
-                if (finalCallbackCopy) {
-                    finalCallbackCopy(avgScore);
-                }
-            },
-            Qt::QueuedConnection);
-    } catch (std::exception const& e) {
-        // 异常处理
-        qDebug() << "Exception in TrainingTask::run(): " << e.what();
-
-        // 复制回调函数，避免捕获this
-        auto finalCallbackCopy = finalCallback;
-
-        // 确保即使发生异常也会调用回调
-        QMetaObject::invokeMethod(
-            QApplication::instance(),
-            [finalCallbackCopy]() {
-                if (finalCallbackCopy) {
-                    finalCallbackCopy(0);  // 发生异常时返回0分
-                }
-            },
-            Qt::QueuedConnection);
-    } catch (...) {
-        qDebug() << "Unknown exception in TrainingTask::run()";
-
-        // 复制回调函数，避免捕获this
-        auto finalCallbackCopy = finalCallback;
-
-        // 确保即使发生异常也会调用回调
-        QMetaObject::invokeMethod(
-            QApplication::instance(),
-            [finalCallbackCopy]() {
-                if (finalCallbackCopy) {
-                    finalCallbackCopy(0);  // 发生异常时返回0分
-                }
-            },
-            Qt::QueuedConnection);
-    }
-}
-
-// 预计算的移动表
-static uint16_t row_left_table[65536];
-static uint16_t row_right_table[65536];
-static uint64_t col_up_table[65536];
-static uint64_t col_down_table[65536];
-
-// 预计算的评分表
-static float heur_score_table[65536];
-static float score_table[65536];
-
-// 常量定义
-static uint64_t const ROW_MASK = 0xFF'FFULL;
-static uint64_t const COL_MASK = 0x00'0F'00'0F'00'0F'00'0FULL;
-
-// 转置棋盘
-inline static BitBoard transpose(BitBoard x) {
-    BitBoard a1 = x & 0xF0'F0'0F'0F'F0'F0'0F'0FULL;
-    BitBoard a2 = x & 0x00'00'F0'F0'00'00'F0'F0ULL;
-    BitBoard a3 = x & 0x0F'0F'00'00'0F'0F'00'00ULL;
-    BitBoard a  = a1 | (a2 << 12) | (a3 >> 12);
-    BitBoard b1 = a & 0xFF'00'FF'00'00'FF'00'FFULL;
-    BitBoard b2 = a & 0x00'FF'00'FF'00'00'00'00ULL;
-    BitBoard b3 = a & 0x00'00'00'00'FF'00'FF'00ULL;
-    return b1 | (b2 >> 24) | (b3 << 24);
-}
-
-// 反转一行
-inline static uint16_t reverse_row(uint16_t row) {
-    return (row >> 12) | ((row >> 4) & 0x00'F0) | ((row << 4) & 0x0F'00) | (row << 12);
-}
-
-// 将列解包为位棋盘
-inline static BitBoard unpack_col(uint16_t row) {
-    BitBoard tmp = row;
-    return (tmp | (tmp << 12ULL) | (tmp << 24ULL) | (tmp << 36ULL)) & COL_MASK;
-}
-
-// 执行向上移动
-inline static BitBoard execute_move_0(BitBoard board) {
-    BitBoard ret  = board;
-    BitBoard t    = transpose(board);
-    ret          ^= col_up_table[(t >> 0) & ROW_MASK] << 0;
-    ret          ^= col_up_table[(t >> 16) & ROW_MASK] << 4;
-    ret          ^= col_up_table[(t >> 32) & ROW_MASK] << 8;
-    ret          ^= col_up_table[(t >> 48) & ROW_MASK] << 12;
-    return ret;
-}
-
-// 执行向下移动
-inline static BitBoard execute_move_1(BitBoard board) {
-    BitBoard ret  = board;
-    BitBoard t    = transpose(board);
-    ret          ^= col_down_table[(t >> 0) & ROW_MASK] << 0;
-    ret          ^= col_down_table[(t >> 16) & ROW_MASK] << 4;
-    ret          ^= col_down_table[(t >> 32) & ROW_MASK] << 8;
-    ret          ^= col_down_table[(t >> 48) & ROW_MASK] << 12;
-    return ret;
-}
-
-// 执行向左移动
-inline static BitBoard execute_move_2(BitBoard board) {
-    BitBoard ret  = board;
-    ret          ^= BitBoard(row_left_table[(board >> 0) & ROW_MASK]) << 0;
-    ret          ^= BitBoard(row_left_table[(board >> 16) & ROW_MASK]) << 16;
-    ret          ^= BitBoard(row_left_table[(board >> 32) & ROW_MASK]) << 32;
-    ret          ^= BitBoard(row_left_table[(board >> 48) & ROW_MASK]) << 48;
-    return ret;
-}
-
-// 执行向右移动
-inline static BitBoard execute_move_3(BitBoard board) {
-    BitBoard ret  = board;
-    ret          ^= BitBoard(row_right_table[(board >> 0) & ROW_MASK]) << 0;
-    ret          ^= BitBoard(row_right_table[(board >> 16) & ROW_MASK]) << 16;
-    ret          ^= BitBoard(row_right_table[(board >> 32) & ROW_MASK]) << 32;
-    ret          ^= BitBoard(row_right_table[(board >> 48) & ROW_MASK]) << 48;
-    return ret;
-}
-
-// 计算空格数 - 优化版本
-int Auto::countEmptyTiles(BitBoard board) {
-    // 使用位操作快速计算空格数
-    board |= (board >> 2) & 0x33'33'33'33'33'33'33'33ULL;
-    board |= (board >> 1);
-    board  = ~board & 0x11'11'11'11'11'11'11'11ULL;
-
-    // 此时每个半字节是：
-    // 0 如果原始半字节非零
-    // 1 如果原始半字节为零
-    // 现在将它们全部相加
-
-    board += board >> 32;
-    board += board >> 16;
-    board += board >> 8;
-    board += board >> 4;  // 如果有16个空位，这可能会溢出到下一个半字节
-
-    return static_cast<int>(board & 0xf);
-}
-
-// 检查游戏是否结束
-bool Auto::isGameOverBitBoard(BitBoard board) {
-    // 如果有空格，游戏未结束
-    if (countEmptyTiles(board) > 0) {
-        return false;
-    }
-
-    // 检查水平方向是否可以合并
-    for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 3; ++j) {
-            int pos1 = (i * 4 + j) * 4;
-            int pos2 = (i * 4 + j + 1) * 4;
-            int val1 = static_cast<int>((board >> pos1) & 0xF);
-            int val2 = static_cast<int>((board >> pos2) & 0xF);
-            if (val1 == val2 && val1 != 0) {
-                return false;  // 可以合并，游戏未结束
-            }
-        }
-    }
-
-    // 检查垂直方向是否可以合并
-    for (int i = 0; i < 3; ++i) {
-        for (int j = 0; j < 4; ++j) {
-            int pos1 = (i * 4 + j) * 4;
-            int pos2 = ((i + 1) * 4 + j) * 4;
-            int val1 = static_cast<int>((board >> pos1) & 0xF);
-            int val2 = static_cast<int>((board >> pos2) & 0xF);
-            if (val1 == val2 && val1 != 0) {
-                return false;  // 可以合并，游戏未结束
-            }
-        }
-    }
-
-    // 没有空格且没有可合并的方块，游戏结束
-    return true;
-}
-
 // 加载持久化数据
 bool Auto::loadPersistentData() {
     // 打印当前工作目录
@@ -304,12 +88,6 @@ Auto::Auto()
     defaultParams[3] = 2.0;  // 单调性权重
     defaultParams[4] = 1.5;  // 合并可能性权重
 
-    // 初始化随机数生成器
-    srand(time(nullptr));
-
-    // 初始化位棋盘的预计算表
-    initTables();
-
     // 尝试加载持久化的训练数据
     if (!loadPersistentData()) {
         qDebug() << "No persistent training data found, using default parameters";
@@ -324,6 +102,11 @@ QString Auto::getDataDirPath() const {
     return "/Users/yimingzhong/Code/2048-qt/build/Debug/2048-qt.app/Contents/MacOS/data";
 }
 
+// 获取N元组网络权重文件路径
+QString Auto::ntupleWeightsPath() const {
+    return getDataDirPath() + "/2048_ntuple_weights.bin";
+}
+
 // 重置历史最佳分数
 void Auto::resetBestHistoricalScore() {
     bestHistoricalScore = 0;
@@ -395,7 +178,6 @@ Auto::~Auto() {
 
     // 清除缓存
     expectimaxCache.clear();
-    bitboardCache.clear();
 
     // 释放任何其他资源
     QThreadPool::globalInstance()->clear();
@@ -418,6 +200,65 @@ QVector<double> Auto::getStrategyParams() const {
     return strategyParams;
 }
 
+// 设置随机节点的展开方式，下一次位棋盘搜索开始时生效
+void Auto::setChanceEnumeration(bool full, double probabilityCutoff) {
+    QMutexLocker locker(&searcherMutex);
+    fullChanceEnumeration   = full;
+    chanceProbabilityCutoff = probabilityCutoff;
+}
+
+// 是否展开所有空格
+bool Auto::getFullChanceEnumeration() const {
+    QMutexLocker locker(&searcherMutex);
+    return fullChanceEnumeration;
+}
+
+// 获取概率剪枝阈值
+double Auto::getChanceProbabilityCutoff() const {
+    QMutexLocker locker(&searcherMutex);
+    return chanceProbabilityCutoff;
+}
+
+// 设置限时搜索是否使用蒙特卡洛树搜索，下一次搜索开始时生效
+void Auto::setUseMonteCarloTreeSearch(bool use) {
+    QMutexLocker locker(&searcherMutex);
+    useMonteCarloTreeSearch = use;
+}
+
+// 限时搜索是否使用蒙特卡洛树搜索
+bool Auto::getUseMonteCarloTreeSearch() const {
+    QMutexLocker locker(&searcherMutex);
+    return useMonteCarloTreeSearch;
+}
+
+// 读取N元组网络的权重文件
+bool Auto::loadNTupleNetwork(QString const& filename) {
+    QString path = filename.isEmpty() ? ntupleWeightsPath() : filename;
+    std::shared_ptr<engine2048::NTupleNetwork const> network =
+        engine2048::NTupleNetwork::load(path.toStdString());
+    if (!network) {
+        qDebug() << "Failed to load n-tuple network from" << path;
+        return false;
+    }
+
+    qDebug() << "Loaded n-tuple network with" << network->tupleCount() << "tuples from" << path;
+    QMutexLocker locker(&searcherMutex);
+    ntupleNetwork = std::move(network);
+    return true;
+}
+
+// 设置位棋盘搜索是否使用N元组网络评估，下一次搜索开始时生效
+void Auto::setUseNTupleEvaluator(bool use) {
+    QMutexLocker locker(&searcherMutex);
+    useNTupleEvaluator = use;
+}
+
+// 位棋盘搜索是否使用N元组网络评估
+bool Auto::getUseNTupleEvaluator() const {
+    QMutexLocker locker(&searcherMutex);
+    return useNTupleEvaluator;
+}
+
 // findBestMove: 找出最佳移动方向
 int Auto::findBestMove(QVector<QVector<int>> const& board) {
     // 检查棋盘上的最大值
@@ -433,16 +274,6 @@ int Auto::findBestMove(QVector<QVector<int>> const& board) {
     // 如果棋盘上有高级方块，尝试使用位棋盘实现以提高性能
     // 但是如果失败，则回退到标准方法
     if (maxValue >= 2048) {
-        // 清除缓存以确保最新的计算结果
-        clearExpectimaxCache();
-
-        // 初始化预计算表（如果还没有初始化）
-        static bool tablesInitialized = false;
-        if (!tablesInitialized) {
-            initTables();
-            tablesInitialized = true;
-        }
-
         // 尝试使用位棋盘实现的最佳移动函数
         try {
             int bestMove = getBestMoveBitBoard(board);
@@ -461,6 +292,18 @@ int Auto::findBestMove(QVector<QVector<int>> const& board) {
         // 如果到达这里，说明位棋盘方法失败，继续使用标准方法
     }
 
+    int bestDirection = standardBestMove(board, 3);
+
+    // 如果没有有效移动，随机选择一个方向
+    if (bestDirection == -1) {
+        bestDirection = static_cast<int>(engine2048::threadRandom().below(4));  // 随机选择一个方向
+    }
+
+    return bestDirection;
+}
+
+// standardBestMove: 标准方法，带学习参数的评估加 depth 层 expectimax，没有可行移动时返回-1
+int Auto::standardBestMove(QVector<QVector<int>> const& board, int depth) {
     int bestScore     = -1;
     int bestDirection = -1;
 
@@ -481,8 +324,8 @@ int Auto::findBestMove(QVector<QVector<int>> const& board) {
             // 先进行基础评估
             score = evaluateWithParams(boardCopy, useLearnedParams ? strategyParams : defaultParams) + moveScore;
 
-            // 使用expectimax算法进行深度为3的搜索
-            int simulationScore  = expectimax(boardCopy, 3, false);
+            // 使用expectimax算法进行深度为 depth 的搜索
+            int simulationScore  = expectimax(boardCopy, depth, false);
             score               += simulationScore;
 
             if (score > bestScore) {
@@ -492,12 +335,128 @@ int Auto::findBestMove(QVector<QVector<int>> const& board) {
         }
     }
 
-    // 如果没有有效移动，随机选择一个方向
-    if (bestDirection == -1) {
-        bestDirection = rand() % 4;  // 随机选择一个方向
+    return bestDirection;
+}
+
+// findBestMoveWithin: 在时间预算内找出最佳移动方向
+int Auto::findBestMoveWithin(QVector<QVector<int>> const& board, int timeBudgetMs) {
+    // 迭代加深的最大深度，实际深度由时间预算决定
+    static int const MAX_ITERATIVE_DEPTH = 12;
+
+    // 低级棋盘沿用带学习参数的标准方法，按深度0到3逐层加深，同样受时间预算和停止请求的限制
+    int maxValue = 0;
+    for (auto const& row : board) {
+        for (int value : row) {
+            maxValue = std::max(maxValue, value);
+        }
+    }
+    if (maxValue < 2048) {
+        return standardBestMoveWithin(board, timeBudgetMs);
     }
 
-    return bestDirection;
+    // 蒙特卡洛树搜索使用同样的时间预算
+    engine2048::MctsSearcher* mcts = nullptr;
+    {
+        QMutexLocker locker(&searcherMutex);
+        if (useMonteCarloTreeSearch) {
+            if (!mctsSearcher) {
+                mctsSearcher = std::make_unique<engine2048::MctsSearcher>();
+            }
+            mcts = mctsSearcher.get();
+        }
+    }
+    if (mcts) {
+        engine2048::SearchResult result =
+            mcts->search(convertToBitBoard(board), std::chrono::milliseconds(timeBudgetMs));
+        qDebug() << "MCTS - Best move:" << result.move << "Mean return:" << result.score
+                 << "Playouts:" << mcts->lastPlayouts();
+        return result.move == -1 ? findBestMove(board) : result.move;
+    }
+
+    engine2048::Searcher& bitboardSearch = bitboardSearcher();
+    BitBoard bitBoard                    = convertToBitBoard(board);
+
+    // 预测搜索已经把这个棋盘搜索到上一步的深度时直接使用
+    engine2048::SearchResult result;
+    if (bitboardSearch.takePonderResult(bitBoard, result) && result.move != -1
+        && result.depth >= std::max(lastSearchDepth, 1)) {
+        qDebug() << "Ponder hit - Best move:" << result.move << "Score:" << result.score << "Depth:" << result.depth;
+        return result.move;
+    }
+
+    result = bitboardSearch.searchIterative(bitBoard, std::chrono::milliseconds(timeBudgetMs), MAX_ITERATIVE_DEPTH);
+    lastSearchDepth = result.depth;
+    qDebug() << "Iterative deepening - Best move:" << result.move << "Score:" << result.score
+             << "Completed depth:" << result.depth;
+
+    // 没有可行移动时交给标准方法处理
+    if (result.move == -1) {
+        return findBestMove(board);
+    }
+    return result.move;
+}
+
+// standardBestMoveWithin: 限时的标准方法，返回最后一个完整完成的深度的结果
+int Auto::standardBestMoveWithin(QVector<QVector<int>> const& board, int timeBudgetMs) {
+    // 与 findBestMove 的标准方法相同的最大深度
+    static int const MAX_STANDARD_DEPTH = 3;
+
+    // 深度0只做一步评估，不受时间限制，保证总有可用的结果
+    int bestMove = standardBestMove(board, 0);
+
+    standardDeadline    = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeBudgetMs);
+    standardHasDeadline = true;
+    standardTimedOut    = false;
+    int completedDepth  = 0;
+    for (int depth = 1; depth <= MAX_STANDARD_DEPTH; ++depth) {
+        int move = standardBestMove(board, depth);
+        if (standardSearchAborted()) {
+            break;
+        }
+        bestMove       = move;
+        completedDepth = depth;
+    }
+    standardHasDeadline = false;
+    qDebug() << "Standard method - Best move:" << bestMove << "Completed depth:" << completedDepth;
+
+    // 与 findBestMove 相同，没有找到有效移动时随机选择一个方向
+    if (bestMove == -1) {
+        bestMove = static_cast<int>(engine2048::threadRandom().below(4));
+    }
+    return bestMove;
+}
+
+// standardSearchAborted: 限时的标准方法是否应当放弃当前深度，每隔一段节点检查一次时间
+bool Auto::standardSearchAborted() {
+    if (standardTimedOut || standardStopRequested.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    if ((++standardNodeCounter & 255) == 0 && std::chrono::steady_clock::now() >= standardDeadline) {
+        standardTimedOut = true;
+    }
+    return standardTimedOut;
+}
+
+// findBestMoves: 批量找出最佳移动方向
+void Auto::findBestMoves(BitBoard const* boards, size_t count, int* moves, int depth) {
+    bitboardSearcher().findBestMoves(boards, count, moves, depth);
+}
+
+// startPonder: 在新方块出现前提前搜索所有可能的后继棋盘
+void Auto::startPonder(QVector<QVector<int>> const& afterstate) {
+    // 只有高级棋盘使用位棋盘搜索，低级棋盘的标准方法本身就很快
+    int maxValue = 0;
+    for (auto const& row : afterstate) {
+        for (int value : row) {
+            maxValue = std::max(maxValue, value);
+        }
+    }
+    if (maxValue < 2048 || getUseMonteCarloTreeSearch()) {
+        return;
+    }
+
+    // 多搜索一层，使下一步的正式搜索也能从置换表中受益
+    bitboardSearcher().startPonder(convertToBitBoard(afterstate), std::max(lastSearchDepth, 1) + 1);
 }
 
 // evaluateBoard: 评估棋盘状态
@@ -1022,189 +981,54 @@ bool Auto::simulateMove(QVector<QVector<int>>& boardState, int direction, int& s
     return moved;
 }
 
-// monteCarloSimulation: 蒙特卡洛模拟
-int Auto::monteCarloSimulation(QVector<QVector<int>> const& boardState, int depth) {
-    if (depth <= 0) {
-        return evaluateBoardAdvanced(boardState);
-    }
-
-    int bestScore = -1;
-
-    // 尝试每个方向
-    for (int direction = 0; direction < 4; ++direction) {
-        QVector<QVector<int>> boardCopy = boardState;
-        int moveScore                   = 0;
-
-        // 模拟移动
-        bool moved = simulateMove(boardCopy, direction, moveScore);
-
-        if (moved) {
-            // 计算当前移动的分数
-            int currentScore = moveScore;
-
-            // 找出空格
-            QVector<QPair<int, int>> emptyTiles;
-            for (int i = 0; i < 4; ++i) {
-                for (int j = 0; j < 4; ++j) {
-                    if (boardCopy[i][j] == 0) {
-                        emptyTiles.append(qMakePair(i, j));
-                    }
-                }
-            }
-
-            if (!emptyTiles.isEmpty()) {
-                // 对于每个空格，模拟生成新方块
-                int totalFutureScore = 0;
-                int simCount         = 0;
-
-                // 为了提高效率，只随机选择一部分空格进行模拟
-                int maxSimulations = std::min(3, static_cast<int>(emptyTiles.size()));
-                for (int sim = 0; sim < maxSimulations; sim++) {
-                    // 随机选择一个空位置
-                    int randomIndex = rand() % emptyTiles.size();
-                    int row         = emptyTiles[randomIndex].first;
-                    int col         = emptyTiles[randomIndex].second;
-
-                    // 模拟生成2和4两种情况
-                    for (int newTile : {2, 4}) {
-                        QVector<QVector<int>> newBoardCopy = boardCopy;
-                        newBoardCopy[row][col]             = newTile;
-
-                        // 递归模拟下一步最佳移动
-                        int futureScore = expectimax(newBoardCopy, depth - 1, false);
-
-                        // 加权平均：2出现90%的概率，4出现10%的概率
-                        double probability  = (newTile == 2) ? 0.9 : 0.1;
-                        totalFutureScore   += static_cast<int>(futureScore * probability);
-                        simCount++;
-                    }
-                }
-
-                // 计算平均未来分数
-                if (simCount > 0) {
-                    currentScore += totalFutureScore / simCount;
-                }
-            }
-
-            // 更新最佳分数
-            if (currentScore > bestScore) {
-                bestScore = currentScore;
-            }
-        }
-    }
-
-    return bestScore > 0 ? bestScore : 0;
-}
-
 // 清除expectimax缓存
 void Auto::clearExpectimaxCache() {
     expectimaxCache.clear();
-    bitboardCache.clear();
-}
 
-// 初始化位棋盘的预计算表
-void Auto::initTables() {
-    // 使用静态标志确保表只初始化一次
-    static std::atomic<bool> tablesInitialized(false);
-    static QMutex initMutex;
-
-    // 如果表已经初始化，则直接返回
-    if (tablesInitialized.load()) {
-        return;
-    }
-
-    // 使用互斥锁确保只有一个线程初始化表
-    QMutexLocker locker(&initMutex);
+    // 位棋盘搜索的置换表不在这里清空：表项与根局面无关，下一步仍可复用，
+    // 旧表项由置换表按世代淘汰
+}
 
-    // 再次检查，防止多个线程同时通过第一次检查
-    if (tablesInitialized.load()) {
-        return;
+// 获取位棋盘搜索器，第一次使用时创建
+engine2048::Searcher& Auto::bitboardSearcher() {
+    QMutexLocker locker(&searcherMutex);
+    if (!searcher) {
+        searcher = std::make_unique<engine2048::Searcher>();
     }
 
-    // 初始化移动表
-    for (int row = 0; row < 65536; ++row) {
-        // 左移表
-        uint16_t line[4] = {static_cast<uint16_t>((row >> 0) & 0xF),
-                            static_cast<uint16_t>((row >> 4) & 0xF),
-                            static_cast<uint16_t>((row >> 8) & 0xF),
-                            static_cast<uint16_t>((row >> 12) & 0xF)};
-
-        // 模拟左移
-        uint16_t result = 0;
-        int score       = 0;
-        bool merged     = false;
-
-        // 先将所有非零元素移动到最左边
-        for (int i = 0; i < 4; ++i) {
-            if (line[i] == 0) {
-                continue;
-            }
-
-            // 找到最左边的空位置
-            int j = i;
-            while (j > 0 && line[j - 1] == 0) {
-                line[j - 1] = line[j];
-                line[j]     = 0;
-                j--;
-                merged = true;
-            }
+    // 设置没有变化时不会清空置换表
+    searcher->stopPonder();
+    searcher->setChanceMode(
+        fullChanceEnumeration ? engine2048::ChanceMode::Full : engine2048::ChanceMode::Sampled,
+        chanceProbabilityCutoff);
 
-            // 如果可以合并
-            if (j > 0 && line[j - 1] == line[j] && line[j] != 0) {
-                line[j - 1]++;  // 对数增加1，相当于值翻倍
-                line[j]  = 0;
-                score   += (1 << line[j - 1]);  // 计算分数
-                merged   = true;
-            }
-        }
-
-        // 将结果打包回16位整数
-        result = static_cast<uint16_t>(line[0] | (line[1] << 4) | (line[2] << 8) | (line[3] << 12));
-
-        // 存储到移动表中
-        row_left_table[row] = result;
-
-        // 右移可以通过左移的逆操作实现
-        uint16_t rev_row     = reverse_row(row);
-        uint16_t rev_result  = reverse_row(row_left_table[rev_row]);
-        row_right_table[row] = rev_result;
-
-        // 上移和下移可以通过转置实现
-        BitBoard row_col   = unpack_col(static_cast<uint16_t>(row));
-        BitBoard row_left  = unpack_col(row_left_table[row]);
-        BitBoard row_right = unpack_col(row_right_table[row]);
-
-        col_up_table[row]   = transpose(row_left);
-        col_down_table[row] = transpose(row_right);
-
-        // 计算评分表
-        float heur_score = 0.0f;
-        float tile_score = 0.0f;
-
-        // 计算每个位置的分数
-        for (int i = 0; i < 4; ++i) {
-            int tile_value = line[i];
-            if (tile_value > 0) {
-                // 使用对数值作为分数
-                tile_score += (1 << tile_value);
-
-                // 奖励递减排列
-                if (i > 0 && line[i - 1] > line[i]) {
-                    heur_score += (line[i - 1] - line[i]) * 0.5f;
-                }
-            }
-        }
+    // 没有读取网络时仍使用启发式评估
+    searcher->setEvaluator(useNTupleEvaluator ? ntupleNetwork : nullptr);
+    return *searcher;
+}
 
-        heur_score_table[row] = heur_score;
-        score_table[row]      = tile_score;
+// 请求正在进行的搜索尽快返回
+void Auto::stopSearch() {
+    standardStopRequested.store(true, std::memory_order_relaxed);
+    QMutexLocker locker(&searcherMutex);
+    if (searcher) {
+        searcher->stop();
     }
+    if (mctsSearcher) {
+        mctsSearcher->stop();
+    }
+}
 
-    // 标记表已初始化
-    tablesInitialized.store(true);
-
-    // 在主线程中输出调试信息
-    QMetaObject::invokeMethod(
-        QApplication::instance(), []() { qDebug() << "BitBoard tables initialized"; }, Qt::QueuedConnection);
+// 清除 stopSearch 留下的停止请求
+void Auto::clearStopRequest() {
+    standardStopRequested.store(false, std::memory_order_relaxed);
+    QMutexLocker locker(&searcherMutex);
+    if (searcher) {
+        searcher->clearStop();
+    }
+    if (mctsSearcher) {
+        mctsSearcher->clearStop();
+    }
 }
 
 // 将标准棋盘转换为位棋盘
@@ -1250,255 +1074,21 @@ QVector<QVector<int>> Auto::convertFromBitBoard(BitBoard board) {
     return result;
 }
 
-// 评估位棋盘
-int Auto::evaluateBitBoard(BitBoard board) {
-    // 使用预计算的表格进行评估
-    float score = 0.0f;
-
-    // 行评估
-    score += heur_score_table[(board >> 0) & ROW_MASK];
-    score += heur_score_table[(board >> 16) & ROW_MASK];
-    score += heur_score_table[(board >> 32) & ROW_MASK];
-    score += heur_score_table[(board >> 48) & ROW_MASK];
-
-    // 列评估（转置后）
-    BitBoard t  = transpose(board);
-    score      += heur_score_table[(t >> 0) & ROW_MASK];
-    score      += heur_score_table[(t >> 16) & ROW_MASK];
-    score      += heur_score_table[(t >> 32) & ROW_MASK];
-    score      += heur_score_table[(t >> 48) & ROW_MASK];
-
-    // 空格数量奖励
-    int emptyTiles  = countEmptyTiles(board);
-    score          += emptyTiles * 30.0f;
-
-    return static_cast<int>(score);
-}
-
-// 模拟移动位棋盘 - 使用直接位操作以提高性能
-bool Auto::simulateMoveBitBoard(BitBoard& board, int direction, int& score) {
-    BitBoard oldBoard = board;
-    score             = 0;
-
-    // 使用直接位操作执行移动
-    switch (direction) {
-        case 0:  // 上
-            board = execute_move_0(board);
-            break;
-        case 1:  // 下
-            board = execute_move_1(board);
-            break;
-        case 2:  // 左
-            board = execute_move_2(board);
-            break;
-        case 3:  // 右
-            board = execute_move_3(board);
-            break;
-        default:
-            qDebug() << "Invalid direction:" << direction;
-            return false;
-    }
-
-    // 如果棋盘没有变化，说明这个方向不能移动
-    if (board == oldBoard) {
-        qDebug() << "BitBoard move in direction" << direction << "did not change the board";
-        return false;
-    }
-
-    // 计算分数 - 分数来自于合并的方块
-    BitBoard diff = oldBoard ^ board;
-    BitBoard temp = diff;
-    while (temp != 0U) {
-        int pos = __builtin_ctzll(temp) / 4 * 4;
-        int val = (board >> pos) & 0xf;
-        if (val > 1) {  // 如果发生了合并
-            score += (1 << val);
-        }
-        temp &= ~(0xfULL << pos);
-    }
-
-    return true;
-}
-
-// 使用位棋盘的expectimax算法
-int Auto::expectimaxBitBoard(BitBoard board, int depth, bool isMaxPlayer) {
-    // 检查缓存
-    BitBoardState state{board, depth, isMaxPlayer};
-    auto cacheIt = bitboardCache.find(state);
-    if (cacheIt != bitboardCache.end()) {
-        return cacheIt->second;
-    }
-
-    // 绝对深度限制 - 防止过深递归
-    static int const MAX_ABSOLUTE_DEPTH = 5;  // 降低最大深度以提高性能
-    depth                               = std::min(depth, MAX_ABSOLUTE_DEPTH);
-
-    // 如果到达最大深度，返回评估分数
-    if (depth <= 0) {
-        // 直接使用位棋盘评估函数
-        int score            = evaluateBitBoard(board);
-        bitboardCache[state] = score;  // 缓存结果
-        return score;
-    }
-
-    // 检测游戏是否结束
-    if (isGameOverBitBoard(board)) {
-        int score            = -500000;  // 游戏结束给予大量惩罚
-        bitboardCache[state] = score;
-        return score;
-    }
-
-    // 快速检测空格数
-    int emptyCount = countEmptyTiles(board);
-
-    // 获取最大值
-    int maxValue = 0;
-    for (int i = 0; i < 16; i++) {
-        int shift = i * 4;
-        int value = (board >> shift) & 0xF;
-        if (value > maxValue) {
-            maxValue = value;
-        }
-    }
-    // 将对数值转换为实际值
-    maxValue = maxValue > 0 ? (1 << maxValue) : 0;
-
-    // 对于高级棋盘，减少搜索深度以提高性能
-    int extraDepth = 0;
-    if (maxValue >= 2048) {  // 2048 = 2^11
-        // 对于高级棋盘，根据空格数量动态调整搜索深度
-        if (emptyCount <= 4) {
-            depth = std::min(depth, 3);  // 空格很少时限制深度
-        } else {
-            extraDepth = 1;  // 空格较多时增加深度
-        }
-    }
-
-    int result = 0;
-    if (isMaxPlayer) {
-        // MAX节点：选择最佳移动
-        int bestScore = -1;
-
-        // 尝试所有可能的移动
-        for (int direction = 0; direction < 4; ++direction) {
-            BitBoard boardCopy = board;
-            int moveScore      = 0;
-
-            bool moved = simulateMoveBitBoard(boardCopy, direction, moveScore);
-
-            if (moved) {
-                // 递归计算期望分数
-                int score = moveScore + expectimaxBitBoard(boardCopy, depth - 1 + extraDepth, false);
-                bestScore = std::max(bestScore, score);
-            }
-        }
-
-        result = bestScore > 0 ? bestScore : 0;
-    } else {
-        // CHANCE节点：随机生成新方块
-        // 如果没有空格，返回评估分数
-        if (emptyCount == 0) {
-            int score            = evaluateBitBoard(board);
-            bitboardCache[state] = score;
-            return score;
-        }
-
-        // 优化：对于高级棋盘，只模拟一个空格以提高性能
-        int tilesToSimulate = 1;
-        if (maxValue < 2048 && emptyCount > 1) {
-            tilesToSimulate = std::min(2, emptyCount);
-        }
-
-        double totalScore = 0.0;
-
-        // 找到所有空格位置
-        QVector<QPair<int, int>> emptyPositions;
-        // 直接从位棋盘获取空格位置
-        for (int i = 0; i < 4; ++i) {
-            for (int j = 0; j < 4; ++j) {
-                int pos = (i * 4 + j) * 4;
-                int val = (board >> pos) & 0xF;
-                if (val == 0) {
-                    emptyPositions.append(qMakePair(i, j));
-                    if (emptyPositions.size() >= tilesToSimulate) {
-                        break;
-                    }
-                }
-            }
-            if (emptyPositions.size() >= tilesToSimulate) {
-                break;
-            }
-        }
-
-        // 模拟在空格中放置新方块
-        for (int i = 0; i < tilesToSimulate; ++i) {
-            int row = emptyPositions[i].first;
-            int col = emptyPositions[i].second;
-
-            // 直接在位棋盘上模拟生成2和4
-            BitBoard bitBoardWith2 = board;
-            int pos2               = (row * 4 + col) * 4;
-            // 清零该位置然后设置为2（1对应于位棋盘中的2）
-            bitBoardWith2 &= ~(0xfULL << pos2);
-            bitBoardWith2 |= 1ULL << pos2;
-
-            // 优化：对于高级棋盘，只考虑生成2的情况
-            if (maxValue >= 4096) {  // 4096 = 2^12
-                totalScore += expectimaxBitBoard(bitBoardWith2, depth - 1, true);
-            } else {
-                // 创建生成4的位棋盘
-                BitBoard bitBoardWith4 = board;
-                // 清零该位置然后设置为4（2对应于位棋盘中的4）
-                bitBoardWith4 &= ~(0xfULL << pos2);
-                bitBoardWith4 |= 2ULL << pos2;
-
-                // 90%概率生成2，10%概率生成4
-                totalScore += 0.9 * expectimaxBitBoard(bitBoardWith2, depth - 1, true);
-                totalScore += 0.1 * expectimaxBitBoard(bitBoardWith4, depth - 1, true);
-            }
-        }
-
-        result = static_cast<int>(totalScore / tilesToSimulate);
-    }
-
-    // 缓存结果
-    bitboardCache[state] = result;
-
-    // 限制缓存大小以防止内存溢出
-    if (bitboardCache.size() > 10000) {
-        // 当缓存过大时清除
-        bitboardCache.clear();
-    }
-
-    return result;
-}
-
 // 使用位棋盘优化的getBestMove函数
 int Auto::getBestMoveBitBoard(QVector<QVector<int>> const& boardState) {
     // 转换为位棋盘
     BitBoard board = convertToBitBoard(boardState);
 
-    int bestMove       = -1;
-    int bestScore      = -1;
-    int validMoveCount = 0;
+    // 根节点的各方向和第一层随机节点并行搜索
+    engine2048::SearchResult result = bitboardSearcher().search(board, 3);
+    int bestMove                    = result.move;
+    int bestScore                   = result.score;
+    int validMoveCount              = 0;
 
-    // 尝试所有可能的移动
     for (int move = 0; move < 4; ++move) {
-        BitBoard boardCopy = board;
-        int moveScore      = 0;
-
-        bool moved = simulateMoveBitBoard(boardCopy, move, moveScore);
-
-        if (moved) {
+        if (result.legalMask & (1U << move)) {
             validMoveCount++;
-            // 计算此移动的分数
-            int score = moveScore + expectimaxBitBoard(boardCopy, 3, false);
-            qDebug() << "BitBoard method - Direction:" << move << "Score:" << score;
-
-            if (score > bestScore) {
-                bestScore = score;
-                bestMove  = move;
-            }
+            qDebug() << "BitBoard method - Direction:" << move << "Score:" << result.scores[move];
         } else {
             qDebug() << "BitBoard method - Direction:" << move << "is not valid";
         }
@@ -1541,6 +1131,11 @@ int Auto::getBestMoveBitBoard(QVector<QVector<int>> const& boardState) {
 
 // expectimax: 期望最大算法 - 高效版本
 int Auto::expectimax(QVector<QVector<int>> const& boardState, int depth, bool isMaxPlayer) {
+    // 限时搜索被中断后尽快返回，这一层的结果会被丢弃
+    if (standardHasDeadline && standardSearchAborted()) {
+        return 0;
+    }
+
     // 检查缓存
     BoardState state{boardState, depth, isMaxPlayer};
     auto cacheIt = expectimaxCache.find(state);
@@ -1669,8 +1264,10 @@ int Auto::expectimax(QVector<QVector<int>> const& boardState, int depth, bool is
         result = static_cast<int>(totalScore / tilesToSimulate);
     }
 
-    // 缓存结果
-    expectimaxCache[state] = result;
+    // 缓存结果，中断时子节点的分数不完整，不能缓存
+    if (!standardHasDeadline || !standardSearchAborted()) {
+        expectimaxCache[state] = result;
+    }
 
     // 限制缓存大小以防止内存溢出
     if (expectimaxCache.size() > 10000) {
@@ -1820,129 +1417,37 @@ int Auto::simulateFullGame(QVector<double> const& params) {
     return score;
 }
 
-// simulateFullGameDetailed: 模拟完整游戏并返回详细信息
-void Auto::simulateFullGameDetailed(QVector<double> const& params, int& score, int& maxTile) {
-    // 初始化模拟棋盘
-    QVector<QVector<int>> simBoard(4, QVector<int>(4, 0));
-    score   = 0;
-    maxTile = 0;
-
-    // 随机生成两个初始方块
-    QVector<QPair<int, int>> emptyTiles;
-    for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 4; ++j) {
-            emptyTiles.append(qMakePair(i, j));
-        }
+// 获取参数化评估表，同一组参数连续模拟多局时只建一次，参数不足5个时使用默认参数
+engine2048::ParamEvaluator const& Auto::paramEvaluator(QVector<double> const& params) {
+    engine2048::HeuristicParams heuristicParams;
+    for (int i = 0; i < static_cast<int>(heuristicParams.size()); ++i) {
+        heuristicParams[i] = i < params.size() ? params[i] : defaultParams[i];
     }
-
-    // 随机选择两个位置生成初始方块
-    std::random_device rd;
-    std::mt19937 gen(rd());
-
-    for (int i = 0; i < 2; ++i) {
-        std::uniform_int_distribution<> posDis(0, static_cast<int>(emptyTiles.size()) - 1);
-        std::uniform_int_distribution<> valueDis(0, 9);  // 0-8 生成2，9 生成4
-
-        int randomIndex    = posDis(gen);
-        int row            = emptyTiles[randomIndex].first;
-        int col            = emptyTiles[randomIndex].second;
-        simBoard[row][col] = (valueDis(gen) < 9) ? 2 : 4;  // 90%的概率生成2，10%生成4
-        emptyTiles.removeAt(randomIndex);
+    if (!selfPlayEvaluator || selfPlayEvaluator->params() != heuristicParams) {
+        selfPlayEvaluator = std::make_unique<engine2048::ParamEvaluator>(heuristicParams);
     }
+    return *selfPlayEvaluator;
+}
 
-    // 模拟游戏过程，直到游戏结束
-    bool gameOver = false;
-    int moveCount = 0;
-    int maxMoves  = 2000;  // 增加最大移动次数，以便能达到2048及以上
-
-    while (!gameOver && moveCount < maxMoves) {
-        // 更新最大砖块值
-        for (int i = 0; i < 4; ++i) {
-            for (int j = 0; j < 4; ++j) {
-                if (simBoard[i][j] > maxTile) {
-                    maxTile = simBoard[i][j];
-                }
-            }
-        }
-
-        // 找出最佳移动方向
-        int bestDirection = -1;
-        int bestScore     = -1;
-
-        // 尝试每个方向
-        for (int direction = 0; direction < 4; ++direction) {
-            QVector<QVector<int>> boardCopy = simBoard;
-            int moveScore                   = 0;
-
-            // 模拟移动
-            bool moved = simulateMove(boardCopy, direction, moveScore);
-
-            if (moved) {
-                // 对于高级棋盘，使用更复杂的评估
-                int evalScore = 0;
-                if (maxTile >= 1024) {
-                    // 对于高级棋盘，使用更复杂的评估和更深的搜索
-                    evalScore = evaluateAdvancedPattern(boardCopy);
-                    // 深度为2的蒙特卡洛模拟
-                    evalScore += monteCarloSimulation(boardCopy, 2);
-                } else {
-                    // 对于低级棋盘，使用参数化评估
-                    evalScore = evaluateWithParams(boardCopy, params);
-                }
-
-                int score = evalScore + moveScore;
-
-                if (score > bestScore) {
-                    bestScore     = score;
-                    bestDirection = direction;
-                }
-            }
-        }
-
-        // 如果没有可用的移动，游戏结束
-        if (bestDirection == -1) {
-            gameOver = true;
-            continue;
-        }
-
-        // 执行最佳移动
-        int moveScore = 0;
-        simulateMove(simBoard, bestDirection, moveScore);
-        score += moveScore;
-        moveCount++;
-
-        // 随机生成新方块
-        emptyTiles.clear();
-        for (int i = 0; i < 4; ++i) {
-            for (int j = 0; j < 4; ++j) {
-                if (simBoard[i][j] == 0) {
-                    emptyTiles.append(qMakePair(i, j));
-                }
-            }
-        }
-
-        if (emptyTiles.isEmpty()) {
-            gameOver = true;
-            continue;
-        }
-
-        std::uniform_int_distribution<> posDis(0, static_cast<int>(emptyTiles.size()) - 1);
-        std::uniform_int_distribution<> valueDis(0, 9);  // 0-8 生成2，9 生成4
-
-        int randomIndex    = posDis(gen);
-        int row            = emptyTiles[randomIndex].first;
-        int col            = emptyTiles[randomIndex].second;
-        simBoard[row][col] = (valueDis(gen) < 9) ? 2 : 4;  // 90%的概率生成2，10%生成4
-    }
+// simulateFullGameDetailed: 模拟完整游戏并返回详细信息
+void Auto::simulateFullGameDetailed(QVector<double> const& params, int& score, int& maxTile) {
+    // 自我对弈在位棋盘上进行
+    engine2048::GameResult result = engine2048::playSelfPlayGame(paramEvaluator(params), engine2048::threadRandom());
+    score                         = result.score;
+    maxTile                       = result.maxTile;
+}
 
-    // 最后再次检查最大砖块值
-    for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 4; ++j) {
-            if (simBoard[i][j] > maxTile) {
-                maxTile = simBoard[i][j];
-            }
-        }
-    }
+// simulateGames: 按步同时模拟多局游戏
+void Auto::simulateGames(QVector<double> const& params,
+                         int games,
+                         quint64 seed,
+                         std::function<void(int score, int maxTile)> const& onGameFinished) {
+    engine2048::playSelfPlayGames(paramEvaluator(params),
+                                  static_cast<size_t>(std::max(games, 0)),
+                                  seed,
+                                  [&onGameFinished](size_t, engine2048::GameResult const& result) {
+                                      onGameFinished(result.score, result.maxTile);
+                                  });
 }
 
 // 评估参数性能 - 更全面地评估参数的效果
@@ -1958,14 +1463,8 @@ int Auto::evaluateParameters(QVector<double> const& params, int simulations) {
     QVector<int> allMaxTiles;
 
     try {
-        // 运行多次模拟游戏并计算平均分数
-        for (int i = 0; i < simulations; ++i) {
-            int gameScore = 0;
-            int gameTile  = 0;
-
-            // 模拟完整游戏并返回分数和最大砖块
-            simulateFullGameDetailed(params, gameScore, gameTile);
-
+        // 同时模拟多局游戏并计算平均分数
+        simulateGames(params, simulations, engine2048::threadRandom().next(), [&](int gameScore, int gameTile) {
             totalScore += gameScore;
             maxTile     = std::max(maxTile, gameTile);
 
@@ -1982,7 +1481,7 @@ int Auto::evaluateParameters(QVector<double> const& params, int simulations) {
                     }
                 }
             }
-        }
+        });
 
         // 计算平均分数和标准差
         int avgScore = totalScore / simulations;
@@ -2225,7 +1724,10 @@ bool Auto::loadParameters(QString const& filename) {
 }
 
 // learnParameters: 学习最佳参数
-void Auto::learnParameters(int populationSize, int generations, int simulations) {
+void Auto::learnParameters(int populationSize,
+                           int generations,
+                           int simulations,
+                           ParameterTrainingOptions const& options) {
     // 如果已经在训练中，则返回
     if (trainingActive.load()) {
         return;
@@ -2233,14 +1735,13 @@ void Auto::learnParameters(int populationSize, int generations, int simulations)
 
     // 清除缓存，确保内存干净
     clearExpectimaxCache();
-    bitboardCache.clear();
 
     // 设置训练状态
     trainingActive.store(true);
 
     // 创建训练线程，避免阻塞主线程
     QThread* trainingThread = new QThread();
-    TrainingWorker* worker  = new TrainingWorker(this, populationSize, generations, simulations);
+    TrainingWorker* worker  = new TrainingWorker(this, populationSize, generations, simulations, options);
     worker->moveToThread(trainingThread);
 
     // 连接信号和槽
@@ -2260,6 +1761,31 @@ void Auto::learnParameters(int populationSize, int generations, int simulations)
     trainingThread->start();
 }
 
+// learnNTupleNetwork: 启动N元组网络的时间差分训练
+void Auto::learnNTupleNetwork(quint64 games, double learningRate, double lambda) {
+    // 如果已经在训练中，则返回
+    if (trainingActive.load()) {
+        return;
+    }
+    trainingActive.store(true);
+
+    // 在单独的线程中训练，训练器内部再把对局分给所有核心
+    QThread* trainingThread  = new QThread();
+    TdTrainingWorker* worker = new TdTrainingWorker(this, games, learningRate, lambda);
+    worker->moveToThread(trainingThread);
+
+    connect(trainingThread, &QThread::started, worker, &TdTrainingWorker::doTraining);
+    connect(worker, &TdTrainingWorker::finished, trainingThread, &QThread::quit);
+    connect(worker, &TdTrainingWorker::finished, worker, &QObject::deleteLater);
+    connect(trainingThread, &QThread::finished, trainingThread, &QObject::deleteLater);
+    connect(trainingThread, &QThread::finished, [this]() {
+        trainingActive.store(false);
+        qDebug() << "TD training thread finished and cleaned up";
+    });
+
+    trainingThread->start();
+}
+
 // findTopIndices: 找出最高分数的索引
 QVector<int> Auto::findTopIndices(QVector<int> const& scores, int count) {
     QVector<int> indices(scores.size());
@@ -2275,16 +1801,12 @@ QVector<int> Auto::findTopIndices(QVector<int> const& scores, int count) {
 }
 
 // tournamentSelection: 选择算法
-int Auto::tournamentSelection(QVector<int> const& scores) {
-    // 使用现代C++随机数生成器
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, static_cast<int>(scores.size()) - 1);
-
+int Auto::tournamentSelection(QVector<int> const& scores, engine2048::FastRandom& random) {
     // 随机选择3个个体进行比赛
-    int a = dis(gen);
-    int b = dis(gen);
-    int c = dis(gen);
+    unsigned count = static_cast<unsigned>(scores.size());
+    int a          = static_cast<int>(random.below(count));
+    int b          = static_cast<int>(random.below(count));
+    int c          = static_cast<int>(random.below(count));
 
     // 返回分数最高的
     if (scores[a] >= scores[b] && scores[a] >= scores[c]) {
@@ -2297,36 +1819,27 @@ int Auto::tournamentSelection(QVector<int> const& scores) {
 }
 
 // crossover: 交叉算法
-QVector<double> Auto::crossover(QVector<double> const& parent1, QVector<double> const& parent2) {
+QVector<double> Auto::crossover(QVector<double> const& parent1,
+                                QVector<double> const& parent2,
+                                engine2048::FastRandom& random) {
     QVector<double> child(parent1.size());
 
-    // 使用现代C++随机数生成器
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 1);
-
     // 均匀交叉
     for (int i = 0; i < parent1.size(); ++i) {
         // 50%的概率从父代1继承，50%的概率从父代2继承
-        child[i] = (dis(gen) == 0) ? parent1[i] : parent2[i];
+        child[i] = random.below(2) == 0 ? parent1[i] : parent2[i];
     }
 
     return child;
 }
 
 // mutate: 变异算法
-void Auto::mutate(QVector<double>& params, double mutationRate) {
-    // 使用现代C++随机数生成器
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> dis(0.0, 1.0);
-    std::uniform_real_distribution<> change_dis(-0.5, 0.5);  // 增大变异幅度到 -50% 到 +50%
-
+void Auto::mutate(QVector<double>& params, engine2048::FastRandom& random, double mutationRate) {
     // 每个参数有 mutationRate 的概率发生变异
     for (int i = 0; i < params.size(); ++i) {
-        if (dis(gen) < mutationRate) {
+        if (random.uniform() < mutationRate) {
             // 变异幅度为当前值的 -50% 到 +50%
-            double change  = params[i] * change_dis(gen);
+            double change  = params[i] * random.uniform(-0.5, 0.5);
             params[i]     += change;
 
             // 确保参数不为负且有上限
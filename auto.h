@@ -1,6 +1,12 @@
 #ifndef AUTO_H
 #define AUTO_H
 
+#include "bitboard.h"
+#include "mcts.h"
+#include "searcher.h"
+#include "self_play.h"
+#include "trainingworker.h"
+
 #include <QApplication>
 #include <QDateTime>
 #include <QFile>
@@ -16,60 +22,12 @@
 #include <QVector>
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstdlib>
-#include <ctime>
 #include <functional>
-#include <random>
+#include <memory>
 #include <unordered_map>
 
-// 位棋盘类型定义
-typedef uint64_t BitBoard;
-
-// 位棋盘状态结构体
-struct BitBoardState {
-    BitBoard board;
-    int depth;
-    bool isMaxPlayer;
-
-    bool operator==(BitBoardState const& other) const {
-        return board == other.board && depth == other.depth && isMaxPlayer == other.isMaxPlayer;
-    }
-};
-
-// 位棋盘状态的哈希函数
-namespace std {
-template <>
-struct hash<BitBoardState> {
-    std::size_t operator()(BitBoardState const& state) const {
-        std::size_t h1 = std::hash<BitBoard>{}(state.board);
-        std::size_t h2 = std::hash<int>{}(state.depth);
-        std::size_t h3 = std::hash<bool>{}(state.isMaxPlayer);
-        return h1 ^ (h2 << 1) ^ (h3 << 2);
-    }
-};
-}  // namespace std
-
-// 训练任务类，用于多线程训练
-class TrainingTask : public QRunnable {
-   public:
-    TrainingTask(QVector<double> params,
-                 int simulations,
-                 std::function<void(int)> finalCallback,
-                 std::function<void(int, int, int)> progressCallback = nullptr)
-        : params(std::move(params)),
-          simulations(simulations),
-          finalCallback(std::move(finalCallback)),
-          progressCallback(std::move(progressCallback)) {}
-
-    void run() override;
-
-   private:
-    QVector<double> params;
-    int simulations;
-    std::function<void(int)> finalCallback;               // 回调函数，返回最终分数
-    std::function<void(int, int, int)> progressCallback;  // 进度回调，参数：当前模拟次数、总模拟次数、当前分数
-};
-
 // 训练工作线程类
 class TrainingWorker;
 
@@ -110,6 +68,22 @@ class Auto : public QObject {
     [[nodiscard]] bool getUseLearnedParams() const;
     [[nodiscard]] QVector<double> getStrategyParams() const;
 
+    // 位棋盘搜索随机节点的展开方式：full 为 true 时展开所有空格的2和4，
+    // 累计概率低于 probabilityCutoff 的分支直接评估；否则只采样前一到两个空格
+    void setChanceEnumeration(bool full, double probabilityCutoff);
+    [[nodiscard]] bool getFullChanceEnumeration() const;
+    [[nodiscard]] double getChanceProbabilityCutoff() const;
+
+    // 高级棋盘的限时搜索改用蒙特卡洛树搜索，时间预算相同，便于比较两种引擎
+    void setUseMonteCarloTreeSearch(bool use);
+    [[nodiscard]] bool getUseMonteCarloTreeSearch() const;
+
+    // 位棋盘搜索的叶节点改用N元组网络评估，网络从权重文件读取（默认为数据目录下的 2048_ntuple_weights.bin）
+    // 读取失败时返回 false，继续使用启发式评估
+    bool loadNTupleNetwork(QString const& filename = "");
+    void setUseNTupleEvaluator(bool use);
+    [[nodiscard]] bool getUseNTupleEvaluator() const;
+
     // 停止训练
     void stopTraining() {
         trainingActive.store(false);
@@ -117,14 +91,40 @@ class Auto : public QObject {
 
     // 主要功能
     int findBestMove(QVector<QVector<int>> const& board);
-    void learnParameters(int populationSize = 150, int generations = 100, int simulations = 50);
+
+    // 在时间预算内找出最佳移动：高级棋盘使用位棋盘迭代加深搜索，时间用完时返回最后完成的深度的结果
+    int findBestMoveWithin(QVector<QVector<int>> const& board, int timeBudgetMs);
+
+    // 批量找出最佳移动：boards 中的 count 个位棋盘各搜索 depth 层，结果写入 moves（没有可行移动时为-1）
+    // 所有棋盘共用一张置换表和线程池，用于离线分析和训练时大批量打分
+    void findBestMoves(BitBoard const* boards, size_t count, int* moves, int depth = 3);
+
+    // 请求正在进行的搜索尽快返回，可以在其他线程调用
+    // 请求一直有效，还没有开始的限时搜索开始后也会立即返回，直到 clearStopRequest()
+    void stopSearch();
+
+    // 清除停止请求：发起新的限时搜索之前调用，不能与搜索并发
+    void clearStopRequest();
+
+    // 走子之后、新方块出现之前调用：在后台提前搜索每一种可能的新方块，
+    // 之后 findBestMoveWithin 遇到已搜索过的棋盘时直接返回结果
+    void startPonder(QVector<QVector<int>> const& afterstate);
+    void learnParameters(int populationSize = 150,
+                         int generations = 100,
+                         int simulations = 50,
+                         ParameterTrainingOptions const& options = {});
+
+    // 用时间差分自我对弈训练N元组网络，完成后保存权重并替换搜索使用的网络
+    void learnNTupleNetwork(quint64 games, double learningRate = 0.1, double lambda = 0.5);
     int simulateFullGame(QVector<double> const& params);
     void simulateFullGameDetailed(QVector<double> const& params, int& score, int& maxTile);
+    // 同时模拟 games 局，对局只由 seed 决定，每局结束时（按结束的先后）用分数和最大方块调用 onGameFinished
+    void simulateGames(QVector<double> const& params,
+                       int games,
+                       quint64 seed,
+                       std::function<void(int score, int maxTile)> const& onGameFinished);
     int evaluateParameters(QVector<double> const& params, int simulations = 50);  // 更全面地评估参数
 
-    // 初始化位棋盘表格 - 公开方法供其他类调用
-    void initTables();
-
     // 保存和加载参数
     bool saveParameters(QString const& filename = "");
     bool savePersistentData(QJsonDocument const& doc);
@@ -145,6 +145,9 @@ class Auto : public QObject {
 
     // 友元类声明
     friend class TrainingWorker;
+    friend class TdTrainingWorker;
+    friend class GeneticOptimizer;
+    friend class SteadyStatePopulation;
 
    private:
     // 策略参数
@@ -188,24 +191,25 @@ class Auto : public QObject {
     // 使用位操作优化的棋盘表示
     typedef uint64_t BitBoard;
 
-    struct BitBoardState {
-        BitBoard board;
-        int depth;
-        bool isMaxPlayer;
+    // 位棋盘搜索器，第一次使用位棋盘搜索时才创建（分配置换表和线程池）
+    std::unique_ptr<engine2048::Searcher> searcher;
+    mutable QMutex searcherMutex;  // 保护 searcher 的创建和下面的设置，搜索本身不持有此锁
+    bool fullChanceEnumeration     = false;
+    double chanceProbabilityCutoff = engine2048::Searcher::kDefaultProbabilityCutoff;
+    int lastSearchDepth            = 0;  // 上一次迭代加深搜索完成的深度，预测结果至少要达到这个深度才直接使用
+    bool useMonteCarloTreeSearch   = false;
+    bool useNTupleEvaluator        = false;
+    std::shared_ptr<engine2048::NTupleNetwork const> ntupleNetwork;  // 未读取时为空
 
-        bool operator==(BitBoardState const& other) const {
-            return board == other.board && depth == other.depth && isMaxPlayer == other.isMaxPlayer;
-        }
-    };
+    // 蒙特卡洛树搜索器，第一次选用时才创建
+    std::unique_ptr<engine2048::MctsSearcher> mctsSearcher;
 
-    struct BitBoardStateHash {
-        std::size_t operator()(BitBoardState const& state) const {
-            return state.board ^ (static_cast<uint64_t>(state.depth) << 32) ^ (state.isMaxPlayer ? 0x1ULL << 63 : 0);
-        }
-    };
+    // 训练模拟用的参数化评估表，参数变化时重建
+    std::unique_ptr<engine2048::ParamEvaluator> selfPlayEvaluator;
+    engine2048::ParamEvaluator const& paramEvaluator(QVector<double> const& params);
 
-    // 位棋盘缓存
-    std::unordered_map<BitBoardState, int, BitBoardStateHash> bitboardCache;
+    // 获取位棋盘搜索器，停止预测搜索并应用当前设置，只在开始搜索前调用
+    engine2048::Searcher& bitboardSearcher();
 
     // 评估函数
     int evaluateBoard(QVector<QVector<int>> const& boardState);
@@ -216,28 +220,39 @@ class Auto : public QObject {
 
     // 数据目录路径
     QString getDataDirPath() const;
+    QString ntupleWeightsPath() const;  // N元组网络权重文件的默认位置
 
     // 位操作相关函数
     BitBoard convertToBitBoard(QVector<QVector<int>> const& boardState);
     QVector<QVector<int>> convertFromBitBoard(BitBoard board);
-    int evaluateBitBoard(BitBoard board);
-    int countEmptyTiles(BitBoard board);
-    bool simulateMoveBitBoard(BitBoard& board, int direction, int& score);
-    int expectimaxBitBoard(BitBoard board, int depth, bool isMaxPlayer);
     int getBestMoveBitBoard(QVector<QVector<int>> const& boardState);
     bool isGameOver(QVector<QVector<int>> const& boardState);
-    bool isGameOverBitBoard(BitBoard board);
 
     // 模拟和搜索
     bool simulateMove(QVector<QVector<int>>& boardState, int direction, int& score);
-    int monteCarloSimulation(QVector<QVector<int>> const& boardState, int depth);
     int expectimax(QVector<QVector<int>> const& boardState, int depth, bool isMaxPlayer);
 
+    // 标准方法：带学习参数的一步评估加 depth 层 expectimax，没有可行移动时返回-1
+    int standardBestMove(QVector<QVector<int>> const& board, int depth);
+
+    // 限时的标准方法：逐层加深到 findBestMove 的深度，超时或收到停止请求时返回最后完成的深度的结果
+    int standardBestMoveWithin(QVector<QVector<int>> const& board, int timeBudgetMs);
+    bool standardSearchAborted();
+
+    // 限时的标准方法的状态，standardHasDeadline 为 false 时 expectimax 不检查时间和停止请求
+    std::atomic<bool> standardStopRequested{false};
+    bool standardHasDeadline = false;
+    bool standardTimedOut    = false;
+    std::chrono::steady_clock::time_point standardDeadline;
+    unsigned standardNodeCounter = 0;
+
     // 遗传算法相关
     QVector<int> findTopIndices(QVector<int> const& scores, int count);
-    int tournamentSelection(QVector<int> const& scores);
-    QVector<double> crossover(QVector<double> const& parent1, QVector<double> const& parent2);
-    void mutate(QVector<double>& params, double mutationRate = 0.2);
+    int tournamentSelection(QVector<int> const& scores, engine2048::FastRandom& random);
+    QVector<double> crossover(QVector<double> const& parent1,
+                              QVector<double> const& parent2,
+                              engine2048::FastRandom& random);
+    void mutate(QVector<double>& params, engine2048::FastRandom& random, double mutationRate = 0.2);
 };
 
 #endif  // AUTO_H
@@ -0,0 +1,109 @@
+#include "bitboard.h"
+
+#include <algorithm>
+
+namespace engine2048 {
+
+namespace {
+
+// 执行向上移动
+inline BitBoard execute_move_up(BitBoard board) {
+    BitBoard ret  = board;
+    BitBoard t    = transpose(board);
+    ret          ^= col_up_table[(t >> 0) & ROW_MASK] << 0;
+    ret          ^= col_up_table[(t >> 16) & ROW_MASK] << 4;
+    ret          ^= col_up_table[(t >> 32) & ROW_MASK] << 8;
+    ret          ^= col_up_table[(t >> 48) & ROW_MASK] << 12;
+    return ret;
+}
+
+// 执行向下移动
+inline BitBoard execute_move_down(BitBoard board) {
+    BitBoard ret  = board;
+    BitBoard t    = transpose(board);
+    ret          ^= col_down_table[(t >> 0) & ROW_MASK] << 0;
+    ret          ^= col_down_table[(t >> 16) & ROW_MASK] << 4;
+    ret          ^= col_down_table[(t >> 32) & ROW_MASK] << 8;
+    ret          ^= col_down_table[(t >> 48) & ROW_MASK] << 12;
+    return ret;
+}
+
+// 执行向左移动
+inline BitBoard execute_move_left(BitBoard board) {
+    BitBoard ret  = board;
+    ret          ^= BitBoard(row_left_table[(board >> 0) & ROW_MASK]) << 0;
+    ret          ^= BitBoard(row_left_table[(board >> 16) & ROW_MASK]) << 16;
+    ret          ^= BitBoard(row_left_table[(board >> 32) & ROW_MASK]) << 32;
+    ret          ^= BitBoard(row_left_table[(board >> 48) & ROW_MASK]) << 48;
+    return ret;
+}
+
+// 执行向右移动
+inline BitBoard execute_move_right(BitBoard board) {
+    BitBoard ret  = board;
+    ret          ^= BitBoard(row_right_table[(board >> 0) & ROW_MASK]) << 0;
+    ret          ^= BitBoard(row_right_table[(board >> 16) & ROW_MASK]) << 16;
+    ret          ^= BitBoard(row_right_table[(board >> 32) & ROW_MASK]) << 32;
+    ret          ^= BitBoard(row_right_table[(board >> 48) & ROW_MASK]) << 48;
+    return ret;
+}
+
+// 四行合并得分之和
+inline int sumMergeScore(BitBoard board) {
+    return static_cast<int>(merge_score_table[(board >> 0) & ROW_MASK] + merge_score_table[(board >> 16) & ROW_MASK]
+                            + merge_score_table[(board >> 32) & ROW_MASK]
+                            + merge_score_table[(board >> 48) & ROW_MASK]);
+}
+
+}  // namespace
+
+int maxRank(BitBoard board) {
+    int maxValue = 0;
+    while (board != 0) {
+        maxValue   = std::max(maxValue, static_cast<int>(board & 0xf));
+        board    >>= 4;
+    }
+    return maxValue;
+}
+
+BitBoard executeMove(BitBoard board, int direction) {
+    switch (direction) {
+        case 0:  // 上
+            return execute_move_up(board);
+        case 1:  // 右
+            return execute_move_right(board);
+        case 2:  // 下
+            return execute_move_down(board);
+        case 3:  // 左
+            return execute_move_left(board);
+        default:
+            return board;
+    }
+}
+
+bool simulateMove(BitBoard& board, int direction, int& score) {
+    BitBoard newBoard = executeMove(board, direction);
+    score             = 0;
+
+    // 如果棋盘没有变化，说明这个方向不能移动
+    if (newBoard == board) {
+        return false;
+    }
+
+    // 左右移动的得分来自各行，上下移动的得分来自各列
+    score = (direction == 1 || direction == 3) ? sumMergeScore(board) : sumMergeScore(transpose(board));
+    board = newBoard;
+    return true;
+}
+
+bool isGameOver(BitBoard board) {
+    // 有空格时游戏未结束
+    if (countEmptyTiles(board) > 0) {
+        return false;
+    }
+
+    // 棋盘已满时，左移和上移都无法改变棋盘说明没有可合并的方块
+    return execute_move_left(board) == board && execute_move_up(board) == board;
+}
+
+}  // namespace engine2048
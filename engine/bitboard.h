@@ -0,0 +1,108 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+
+// 位棋盘类型定义：16个格子，每格4位，存放方块值的对数（0表示空格）
+// 第 i 行第 j 列的格子位于 (i * 4 + j) * 4 位
+typedef uint64_t BitBoard;
+
+namespace engine2048 {
+
+// 常量定义
+static uint64_t const ROW_MASK = 0xFF'FFULL;
+static uint64_t const COL_MASK = 0x00'0F'00'0F'00'0F'00'0FULL;
+
+// 预计算表，在编译期生成（见 bitboard_tables.cpp）
+struct BitBoardTables {
+    // 移动表，存放的是移动前后的异或差值
+    uint16_t row_left_table[65536];
+    uint16_t row_right_table[65536];
+    uint64_t col_up_table[65536];
+    uint64_t col_down_table[65536];
+
+    // 评分表
+    float heur_score_table[65536];
+    float score_table[65536];
+    uint32_t merge_score_table[65536];  // 一行移动时合并得到的分数（左右方向相同）
+};
+
+extern BitBoardTables const tables;
+
+// 各张表的别名，直接解析为只读数据段中的地址，没有额外的间接访问
+inline constexpr uint16_t const (&row_left_table)[65536]    = tables.row_left_table;
+inline constexpr uint16_t const (&row_right_table)[65536]   = tables.row_right_table;
+inline constexpr uint64_t const (&col_up_table)[65536]      = tables.col_up_table;
+inline constexpr uint64_t const (&col_down_table)[65536]    = tables.col_down_table;
+inline constexpr float const (&heur_score_table)[65536]     = tables.heur_score_table;
+inline constexpr float const (&score_table)[65536]          = tables.score_table;
+inline constexpr uint32_t const (&merge_score_table)[65536] = tables.merge_score_table;
+
+// 转置棋盘
+inline BitBoard transpose(BitBoard x) {
+    BitBoard a1 = x & 0xF0'F0'0F'0F'F0'F0'0F'0FULL;
+    BitBoard a2 = x & 0x00'00'F0'F0'00'00'F0'F0ULL;
+    BitBoard a3 = x & 0x0F'0F'00'00'0F'0F'00'00ULL;
+    BitBoard a  = a1 | (a2 << 12) | (a3 >> 12);
+    BitBoard b1 = a & 0xFF'00'FF'00'00'FF'00'FFULL;
+    BitBoard b2 = a & 0x00'FF'00'FF'00'00'00'00ULL;
+    BitBoard b3 = a & 0x00'00'00'00'FF'00'FF'00ULL;
+    return b1 | (b2 >> 24) | (b3 << 24);
+}
+
+// 计算空格数
+inline int countEmptyTiles(BitBoard board) {
+    board |= (board >> 2) & 0x33'33'33'33'33'33'33'33ULL;
+    board |= (board >> 1);
+    board  = ~board & 0x11'11'11'11'11'11'11'11ULL;
+
+    // 此时每个半字节为1表示原始格子为空，先两两相加到字节中，再用乘法把8个字节累加到最高字节
+    // 按字节累加可以容纳16个空位的情况，不会溢出到相邻的半字节
+    board = (board & 0x01'01'01'01'01'01'01'01ULL) + ((board >> 4) & 0x01'01'01'01'01'01'01'01ULL);
+    return static_cast<int>((board * 0x01'01'01'01'01'01'01'01ULL) >> 56);
+}
+
+// 获取指定格子的对数值
+inline int getTile(BitBoard board, int index) {
+    return static_cast<int>((board >> (index * 4)) & 0xf);
+}
+
+// 设置指定格子的对数值
+inline BitBoard setTile(BitBoard board, int index, int rank) {
+    int shift = index * 4;
+    return (board & ~(0xfULL << shift)) | (static_cast<BitBoard>(rank & 0xf) << shift);
+}
+
+// 棋盘上最大方块的对数值
+int maxRank(BitBoard board);
+
+// 执行移动，方向约定与界面一致：0=上，1=右，2=下，3=左
+// 返回移动后的棋盘，方向无效时返回原棋盘
+BitBoard executeMove(BitBoard board, int direction);
+
+// 模拟移动：棋盘发生变化时返回true，并通过score返回合并得分
+bool simulateMove(BitBoard& board, int direction, int& score);
+
+// 一个棋盘四个方向的移动结果
+struct MoveSet {
+    BitBoard boards[4];  // 各方向移动后的棋盘，下标即方向
+    int scores[4];       // 各方向的合并得分
+    unsigned legalMask;  // 第 d 位为1表示方向 d 可以移动
+};
+
+// 一次计算四个方向的移动结果，供搜索的MAX节点使用
+// 共享一次转置，左右、上下的合并得分各查一次表；处理器支持AVX2时用gather指令批量查表
+MoveSet executeAllMoves(BitBoard board);
+
+// 列出所有空格的下标（0-15，按从低位到高位的顺序），返回空格数
+int emptyCells(BitBoard board, int cells[16]);
+
+// 启发式评估位棋盘
+int evaluateBoard(BitBoard board);
+
+// 检查游戏是否结束
+bool isGameOver(BitBoard board);
+
+}  // namespace engine2048
+
+#endif  // BITBOARD_H
@@ -0,0 +1,226 @@
+#include "bitboard.h"
+#include "cpu_features.h"
+
+#if ENGINE2048_X86_DISPATCH
+#    include <immintrin.h>
+#endif
+
+// 热点函数的多个指令集版本，启动时按处理器选择一次（见 cpu_features.h）
+// 通用版本在任何平台上都可用，各加速版本的结果与之完全一致
+
+namespace engine2048 {
+
+namespace {
+
+// ---------------- 通用实现 ----------------
+
+// 已知转置结果时计算四个方向的移动：16次移动表查询和8次得分表查询
+inline MoveSet allMovesFrom(BitBoard board, BitBoard t) {
+    BitBoard up    = board;
+    BitBoard down  = board;
+    BitBoard left  = board;
+    BitBoard right = board;
+    int horizontal = 0;
+    int vertical   = 0;
+
+    for (int i = 0; i < 4; ++i) {
+        auto row = static_cast<uint16_t>((board >> (i * 16)) & ROW_MASK);
+        auto col = static_cast<uint16_t>((t >> (i * 16)) & ROW_MASK);
+
+        left       ^= BitBoard(row_left_table[row]) << (i * 16);
+        right      ^= BitBoard(row_right_table[row]) << (i * 16);
+        up         ^= col_up_table[col] << (i * 4);
+        down       ^= col_down_table[col] << (i * 4);
+        horizontal += static_cast<int>(merge_score_table[row]);
+        vertical   += static_cast<int>(merge_score_table[col]);
+    }
+
+    MoveSet moves{};
+    moves.boards[0] = up;
+    moves.boards[1] = right;
+    moves.boards[2] = down;
+    moves.boards[3] = left;
+    moves.scores[0] = vertical;
+    moves.scores[1] = horizontal;
+    moves.scores[2] = vertical;
+    moves.scores[3] = horizontal;
+
+    for (int direction = 0; direction < 4; ++direction) {
+        if (moves.boards[direction] != board) {
+            moves.legalMask |= 1U << direction;
+        }
+    }
+    return moves;
+}
+
+// 已知转置结果时的启发式评估：四行加四列
+inline int evaluateFrom(BitBoard board, BitBoard t) {
+    float score = 0.0f;
+    for (int i = 0; i < 4; ++i) {
+        score += heur_score_table[(board >> (i * 16)) & ROW_MASK];
+        score += heur_score_table[(t >> (i * 16)) & ROW_MASK];
+    }
+    return static_cast<int>(score);
+}
+
+// 空格标记：空格所在半字节的最低位为1，其余位为0
+inline BitBoard emptyFlags(BitBoard board) {
+    board |= (board >> 2) & 0x33'33'33'33'33'33'33'33ULL;
+    board |= (board >> 1);
+    return ~board & 0x11'11'11'11'11'11'11'11ULL;
+}
+
+MoveSet executeAllMovesGeneric(BitBoard board) {
+    return allMovesFrom(board, transpose(board));
+}
+
+int evaluateBoardGeneric(BitBoard board) {
+    return evaluateFrom(board, transpose(board));
+}
+
+int emptyCellsGeneric(BitBoard board, int cells[16]) {
+    BitBoard flags = emptyFlags(board);
+    int count      = 0;
+    for (int i = 0; i < 16; ++i) {
+        if ((flags >> (i * 4)) & 1) {
+            cells[count++] = i;
+        }
+    }
+    return count;
+}
+
+#if ENGINE2048_X86_DISPATCH
+
+// ---------------- x86-64 加速实现 ----------------
+
+// 用 PEXT 转置：每次取出一列的四个半字节，紧凑排列后恰好是转置后的一行
+ENGINE2048_TARGET("bmi2") inline BitBoard transposePext(BitBoard board) {
+    return _pext_u64(board, COL_MASK) | (_pext_u64(board, COL_MASK << 4) << 16)
+           | (_pext_u64(board, COL_MASK << 8) << 32) | (_pext_u64(board, COL_MASK << 12) << 48);
+}
+
+ENGINE2048_TARGET("bmi2") MoveSet executeAllMovesBmi2(BitBoard board) {
+    return allMovesFrom(board, transposePext(board));
+}
+
+ENGINE2048_TARGET("bmi2") int evaluateBoardBmi2(BitBoard board) {
+    return evaluateFrom(board, transposePext(board));
+}
+
+// 用 POPCNT 直接得到空格数，再逐个取出最低的空格标记
+ENGINE2048_TARGET("popcnt") int emptyCellsPopcnt(BitBoard board, int cells[16]) {
+    BitBoard flags = emptyFlags(board);
+    int count      = __builtin_popcountll(flags);
+    for (int i = 0; i < count; ++i) {
+        cells[i]  = __builtin_ctzll(flags) >> 2;
+        flags    &= flags - 1;
+    }
+    return count;
+}
+
+// AVX2实现：四行（列）的表项用一条gather指令取回，四个方向的差值在一个256位寄存器中合并
+// 16位的行表按32位读取后再截断，最后一项会多读2字节，落在 BitBoardTables 中紧随其后的表内
+ENGINE2048_TARGET("avx2") MoveSet executeAllMovesAvx2(BitBoard board) {
+    BitBoard t = transpose(board);
+
+    // 四行、四列的下标，零扩展为32位
+    __m128i rowIndex = _mm_cvtepu16_epi32(_mm_cvtsi64_si128(static_cast<long long>(board)));
+    __m128i colIndex = _mm_cvtepu16_epi32(_mm_cvtsi64_si128(static_cast<long long>(t)));
+
+    __m128i const lowMask  = _mm_set1_epi32(0xFF'FF);
+    __m256i const rowShift = _mm256_setr_epi64x(0, 16, 32, 48);
+    __m256i const colShift = _mm256_setr_epi64x(0, 4, 8, 12);
+
+    // 各方向每一行（列）的差值，已移到对应位置
+    __m256i up = _mm256_sllv_epi64(
+        _mm256_i32gather_epi64(reinterpret_cast<long long const*>(col_up_table), colIndex, 8), colShift);
+    __m256i down = _mm256_sllv_epi64(
+        _mm256_i32gather_epi64(reinterpret_cast<long long const*>(col_down_table), colIndex, 8), colShift);
+    __m256i left = _mm256_sllv_epi64(
+        _mm256_cvtepu32_epi64(
+            _mm_and_si128(_mm_i32gather_epi32(reinterpret_cast<int const*>(row_left_table), rowIndex, 2), lowMask)),
+        rowShift);
+    __m256i right = _mm256_sllv_epi64(
+        _mm256_cvtepu32_epi64(
+            _mm_and_si128(_mm_i32gather_epi32(reinterpret_cast<int const*>(row_right_table), rowIndex, 2), lowMask)),
+        rowShift);
+
+    // 把四个向量各自的四个分量异或到一起，得到 [上, 右, 下, 左] 的完整差值
+    __m256i upRight   = _mm256_xor_si256(_mm256_unpacklo_epi64(up, right), _mm256_unpackhi_epi64(up, right));
+    __m256i downLeft  = _mm256_xor_si256(_mm256_unpacklo_epi64(down, left), _mm256_unpackhi_epi64(down, left));
+    __m256i deltas    = _mm256_xor_si256(_mm256_permute2x128_si256(upRight, downLeft, 0x20),
+                                      _mm256_permute2x128_si256(upRight, downLeft, 0x31));
+    __m256i newBoards = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(board)), deltas);
+
+    // 差值为零的方向不能移动
+    int unchanged = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(deltas, _mm256_setzero_si256())));
+
+    // 合并得分：左右方向来自各行，上下方向来自各列
+    __m128i rowScores = _mm_i32gather_epi32(reinterpret_cast<int const*>(merge_score_table), rowIndex, 4);
+    __m128i colScores = _mm_i32gather_epi32(reinterpret_cast<int const*>(merge_score_table), colIndex, 4);
+    __m128i sums      = _mm_hadd_epi32(rowScores, colScores);
+    sums              = _mm_hadd_epi32(sums, sums);
+    int horizontal    = _mm_cvtsi128_si32(sums);
+    int vertical      = _mm_extract_epi32(sums, 1);
+
+    MoveSet moves{};
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(moves.boards), newBoards);
+    moves.scores[0] = vertical;
+    moves.scores[1] = horizontal;
+    moves.scores[2] = vertical;
+    moves.scores[3] = horizontal;
+    moves.legalMask = ~static_cast<unsigned>(unchanged) & 0xfU;
+    return moves;
+}
+
+#endif
+
+// ---------------- 分派 ----------------
+
+struct Kernels {
+    MoveSet (*executeAllMoves)(BitBoard);
+    int (*evaluateBoard)(BitBoard);
+    int (*emptyCells)(BitBoard, int*);
+};
+
+Kernels selectKernels() {
+    Kernels kernels{executeAllMovesGeneric, evaluateBoardGeneric, emptyCellsGeneric};
+
+#if ENGINE2048_X86_DISPATCH
+    CpuFeatures const& cpu = cpuFeatures();
+    if (cpu.avx2) {
+        kernels.executeAllMoves = executeAllMovesAvx2;
+    } else if (cpu.bmi2) {
+        kernels.executeAllMoves = executeAllMovesBmi2;
+    }
+    if (cpu.bmi2) {
+        kernels.evaluateBoard = evaluateBoardBmi2;
+    }
+    if (cpu.popcnt) {
+        kernels.emptyCells = emptyCellsPopcnt;
+    }
+#endif
+
+    return kernels;
+}
+
+Kernels const& kernels() {
+    static Kernels const selected = selectKernels();
+    return selected;
+}
+
+}  // namespace
+
+MoveSet executeAllMoves(BitBoard board) {
+    return kernels().executeAllMoves(board);
+}
+
+int evaluateBoard(BitBoard board) {
+    return kernels().evaluateBoard(board);
+}
+
+int emptyCells(BitBoard board, int cells[16]) {
+    return kernels().emptyCells(board, cells);
+}
+
+}  // namespace engine2048
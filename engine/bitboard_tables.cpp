@@ -0,0 +1,144 @@
+#include "bitboard.h"
+
+// 预计算表在编译期生成，直接放在只读数据段中，运行时无需初始化
+// 生成过程的计算量较大，CMakeLists.txt 中为本文件单独放宽了编译器的常量求值步数限制
+
+namespace engine2048 {
+
+namespace {
+
+// rank^3.5，std::pow 不是 constexpr，这里直接列出结果
+constexpr float kRankPow35[16] = {0.0f,
+                                  1.0f,
+                                  11.313708498984761f,
+                                  46.76537180435969f,
+                                  128.0f,
+                                  279.5084971874737f,
+                                  529.0897844411664f,
+                                  907.4926996951546f,
+                                  1448.1546878700494f,
+                                  2187.0f,
+                                  3162.2776601683795f,
+                                  4414.427595963037f,
+                                  5985.96759095804f,
+                                  7921.396152194385f,
+                                  10267.107869307694f,
+                                  13071.318793450033f};
+
+// rank^4
+constexpr float kRankPow4[16] = {
+    0, 1, 16, 81, 256, 625, 1296, 2401, 4096, 6561, 10000, 14641, 20736, 28561, 38416, 50625};
+
+// 反转一行
+constexpr uint16_t reverse_row(uint16_t row) {
+    return static_cast<uint16_t>((row >> 12) | ((row >> 4) & 0x00'F0) | ((row << 4) & 0x0F'00) | (row << 12));
+}
+
+// 将一行解包为位棋盘中的一列
+constexpr BitBoard unpack_col(uint16_t row) {
+    BitBoard tmp = row;
+    return (tmp | (tmp << 12ULL) | (tmp << 24ULL) | (tmp << 36ULL)) & COL_MASK;
+}
+
+constexpr BitBoardTables buildTables() {
+    BitBoardTables t{};
+
+    for (unsigned row = 0; row < 65536; ++row) {
+        unsigned line[4] = {(row >> 0) & 0xf, (row >> 4) & 0xf, (row >> 8) & 0xf, (row >> 12) & 0xf};
+
+        // 游戏分数：假设所有方块都由2合成
+        float score = 0.0f;
+        for (unsigned rank : line) {
+            if (rank >= 2) {
+                score += static_cast<float>((rank - 1) * (1U << rank));
+            }
+        }
+        t.score_table[row] = score;
+
+        // 启发式评分：空格、可合并数、单调性和方块大小
+        float sum   = 0;
+        int empty   = 0;
+        int merges  = 0;
+        int prev    = 0;
+        int counter = 0;
+
+        for (unsigned rank : line) {
+            sum += kRankPow35[rank];
+            if (rank == 0) {
+                empty++;
+            } else {
+                if (prev == static_cast<int>(rank)) {
+                    counter++;
+                } else if (counter > 0) {
+                    merges  += 1 + counter;
+                    counter  = 0;
+                }
+                prev = static_cast<int>(rank);
+            }
+        }
+        if (counter > 0) {
+            merges += 1 + counter;
+        }
+
+        float monotonicity_left  = 0;
+        float monotonicity_right = 0;
+        for (int i = 1; i < 4; ++i) {
+            if (line[i - 1] > line[i]) {
+                monotonicity_left += kRankPow4[line[i - 1]] - kRankPow4[line[i]];
+            } else {
+                monotonicity_right += kRankPow4[line[i]] - kRankPow4[line[i - 1]];
+            }
+        }
+        float monotonicity = monotonicity_left < monotonicity_right ? monotonicity_left : monotonicity_right;
+
+        t.heur_score_table[row] = 200000.0f + 270.0f * static_cast<float>(empty)
+                                  + 700.0f * static_cast<float>(merges) - 47.0f * monotonicity - 11.0f * sum;
+
+        // 执行向左移动，每个方块在一次移动中最多合并一次
+        uint32_t mergeScore = 0;
+        for (int i = 0; i < 3; ++i) {
+            int j = i + 1;
+            while (j < 4 && line[j] == 0) {
+                ++j;
+            }
+            if (j == 4) {
+                break;  // 右侧没有更多方块
+            }
+
+            if (line[i] == 0) {
+                line[i] = line[j];
+                line[j] = 0;
+                i--;  // 重试此位置
+            } else if (line[i] == line[j]) {
+                if (line[i] != 0xf) {
+                    // 32768 + 32768 仍记为 32768
+                    line[i]++;
+                }
+                mergeScore += 1U << line[i];
+                line[j]     = 0;
+            }
+        }
+
+        auto result         = static_cast<uint16_t>(line[0] | (line[1] << 4) | (line[2] << 8) | (line[3] << 12));
+        uint16_t rev_result = reverse_row(result);
+        uint16_t rev_row    = reverse_row(static_cast<uint16_t>(row));
+
+        t.merge_score_table[row]   = mergeScore;
+        t.row_left_table[row]      = static_cast<uint16_t>(row ^ result);
+        t.row_right_table[rev_row] = static_cast<uint16_t>(rev_row ^ rev_result);
+        t.col_up_table[row]        = unpack_col(static_cast<uint16_t>(row)) ^ unpack_col(result);
+        t.col_down_table[rev_row]  = unpack_col(rev_row) ^ unpack_col(rev_result);
+    }
+
+    return t;
+}
+
+}  // namespace
+
+constexpr BitBoardTables tables = buildTables();
+
+// 编译期自检：[2,2,4,0] 左移为 [4,4,0,0]，得分为 4
+static_assert((0x02'11U ^ tables.row_left_table[0x02'11]) == 0x00'22U, "row_left_table is broken");
+static_assert(tables.merge_score_table[0x02'11] == 4, "merge_score_table is broken");
+
+}  // namespace engine2048
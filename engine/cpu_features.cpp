@@ -0,0 +1,32 @@
+#include "cpu_features.h"
+
+#include <cstdlib>
+
+namespace engine2048 {
+
+namespace {
+
+CpuFeatures detectCpuFeatures() {
+    CpuFeatures features;
+    if (std::getenv("ENGINE2048_NO_SIMD") != nullptr) {
+        return features;
+    }
+
+#if ENGINE2048_X86_DISPATCH
+    __builtin_cpu_init();
+    features.popcnt = __builtin_cpu_supports("popcnt");
+    features.avx2   = __builtin_cpu_supports("avx2");
+    features.bmi2   = __builtin_cpu_supports("bmi2") && !__builtin_cpu_is("znver1") && !__builtin_cpu_is("znver2");
+#endif
+
+    return features;
+}
+
+}  // namespace
+
+CpuFeatures const& cpuFeatures() {
+    static CpuFeatures const features = detectCpuFeatures();
+    return features;
+}
+
+}  // namespace engine2048
@@ -0,0 +1,28 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+// x86-64 上用 GCC/Clang 的 target 属性为同一函数编译多个指令集版本，运行时按处理器选择
+// 其他平台（ARM、MSVC 等）只编译通用实现
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#    define ENGINE2048_X86_DISPATCH 1
+#    define ENGINE2048_TARGET(features) __attribute__((target(features)))
+#else
+#    define ENGINE2048_X86_DISPATCH 0
+#endif
+
+namespace engine2048 {
+
+// 处理器支持的指令集扩展
+struct CpuFeatures {
+    bool popcnt = false;
+    bool bmi2   = false;  // 仅在 PEXT/PDEP 为硬件实现时置位（Zen 2 及更早的 AMD 处理器为微码实现，极慢）
+    bool avx2   = false;
+};
+
+// 启动时检测一次，之后直接返回缓存结果
+// 设置环境变量 ENGINE2048_NO_SIMD 可强制使用通用实现，便于对比和排查问题
+CpuFeatures const& cpuFeatures();
+
+}  // namespace engine2048
+
+#endif  // CPU_FEATURES_H
@@ -0,0 +1,42 @@
+#include "fast_random.h"
+
+#include <atomic>
+#include <mutex>
+#include <random>
+
+namespace engine2048 {
+
+namespace {
+
+// 线程生成器的 stream 放在高半区，与调用方显式指定的小序号 stream 分开
+uint64_t const kThreadStreamBase = 1ULL << 63;
+
+std::once_flag seedOnce;
+std::atomic<uint64_t> processSeed{0};
+std::atomic<uint64_t> threadStreams{0};
+
+void initializeSeed() {
+    std::random_device device;
+    processSeed.store((static_cast<uint64_t>(device()) << 32) | device(), std::memory_order_relaxed);
+}
+
+}  // namespace
+
+uint64_t randomSeed() {
+    std::call_once(seedOnce, initializeSeed);
+    return processSeed.load(std::memory_order_relaxed);
+}
+
+void setRandomSeed(uint64_t seed) {
+    // 先完成默认初始化，之后的 randomSeed() 不会再覆盖这里设置的值
+    std::call_once(seedOnce, initializeSeed);
+    processSeed.store(seed, std::memory_order_relaxed);
+}
+
+FastRandom& threadRandom() {
+    thread_local FastRandom random(randomSeed(),
+                                   kThreadStreamBase | threadStreams.fetch_add(1, std::memory_order_relaxed));
+    return random;
+}
+
+}  // namespace engine2048
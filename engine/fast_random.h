@@ -0,0 +1,91 @@
+#ifndef FAST_RANDOM_H
+#define FAST_RANDOM_H
+
+#include "bitboard.h"
+
+#include <cmath>
+#include <cstdint>
+
+namespace engine2048 {
+
+// xoshiro256** 随机数生成器，比 std::mt19937 小且快，统计质量足够用于模拟、自我对弈和遗传算法
+//
+// 种子由 (seed, stream) 两部分组成，经 splitmix64 展开成256位状态：同一个 seed 的不同 stream
+// 互不相关，可以给每个线程、每个任务、每局对局分配一个独立的随机序列，且结果只由 seed 决定。
+// 不是线程安全的，每个线程使用自己的实例。
+class FastRandom {
+   public:
+    explicit FastRandom(uint64_t seed, uint64_t stream = 0) {
+        uint64_t mixer = seed ^ splitMix(stream);
+        for (uint64_t& word : state) {
+            mixer += 0x9E37'79B9'7F4A'7C15ULL;
+            word   = splitMix(mixer);
+        }
+    }
+
+    uint64_t next() {
+        uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+        uint64_t t      = state[1] << 17;
+        state[2]       ^= state[0];
+        state[3]       ^= state[1];
+        state[1]       ^= state[2];
+        state[0]       ^= state[3];
+        state[2]       ^= t;
+        state[3]        = rotateLeft(state[3], 45);
+        return result;
+    }
+
+    // [0, n) 内的整数
+    unsigned below(unsigned n) { return static_cast<unsigned>(((next() >> 32) * n) >> 32); }
+
+    // [0, 1) 内的浮点数
+    double uniform() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+    // [low, high) 内的浮点数
+    double uniform(double low, double high) { return low + (high - low) * uniform(); }
+
+    // 标准正态分布，Box-Muller 变换，每次消耗两个均匀数
+    double normal() {
+        double radius = std::sqrt(-2.0 * std::log(1.0 - uniform()));
+        return radius * std::cos(2.0 * 3.14159265358979323846 * uniform());
+    }
+
+   private:
+    static uint64_t rotateLeft(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    // splitmix64 的输出函数，把相邻的输入打散成不相关的64位值
+    static uint64_t splitMix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58'476D'1CE4'E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D0'49BB'1331'11EBULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t state[4];
+};
+
+// 进程的随机数种子，第一次使用前没有设置时取一次系统随机数
+// 所有随机序列都由它和各自的 stream 派生，固定种子即可复现一次训练
+uint64_t randomSeed();
+
+// 设置进程的随机数种子，应在创建任何随机数生成器之前调用
+void setRandomSeed(uint64_t seed);
+
+// 当前线程的随机数生成器，第一次使用时以 randomSeed() 和线程的登记序号为 stream 创建
+// 线程之间没有共享状态；序号按线程第一次调用的先后分配，需要可复现的任务应自己用固定的 stream 创建
+FastRandom& threadRandom();
+
+// 在随机空格放一个新方块：2的概率为90%，4为10%，没有空格时返回原棋盘
+inline BitBoard spawnRandomTile(BitBoard board, FastRandom& random) {
+    int cells[16];
+    int emptyCount = emptyCells(board, cells);
+    if (emptyCount == 0) {
+        return board;
+    }
+    int cell = cells[random.below(static_cast<unsigned>(emptyCount))];
+    int rank = random.below(10) == 0 ? 2 : 1;
+    return board | (static_cast<BitBoard>(rank) << (cell * 4));
+}
+
+}  // namespace engine2048
+
+#endif  // FAST_RANDOM_H
@@ -0,0 +1,292 @@
+#include "mcts.h"
+
+#include "fast_random.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <vector>
+
+namespace engine2048 {
+
+namespace {
+
+// UCT 的探索系数，各方向的平均回报先除以同一节点下最大的平均回报再使用
+double const kExploration = 0.5;
+
+// 随机模拟的最大步数，后期棋盘随机走子要很久才会结束
+int const kMaxRolloutMoves = 200;
+
+// 单棵树的决策节点上限，超过后不再扩展，只做模拟
+size_t const kMaxTreeNodes = 1 << 18;
+
+// 每隔多少次迭代检查一次是否超时
+int const kDeadlineCheckInterval = 64;
+
+// 从新方块已经放好的棋盘开始随机走子，返回累计的合并分数
+double rollout(BitBoard board, FastRandom& random) {
+    double reward = 0.0;
+    for (int step = 0; step < kMaxRolloutMoves; ++step) {
+        MoveSet moves = executeAllMoves(board);
+        if (moves.legalMask == 0) {
+            break;
+        }
+
+        // 在可行方向中均匀选择
+        int legal[4];
+        unsigned legalCount = 0;
+        for (int direction = 0; direction < 4; ++direction) {
+            if (moves.legalMask & (1U << direction)) {
+                legal[legalCount++] = direction;
+            }
+        }
+        int direction = legal[random.below(legalCount)];
+
+        reward += moves.scores[direction];
+        board   = spawnRandomTile(moves.boards[direction], random);
+    }
+    return reward;
+}
+
+// 一棵搜索树，节点存放在数组中，用下标互相引用
+struct Tree {
+    // 随机节点的一个已展开的后继
+    struct Outcome {
+        BitBoard board;
+        uint32_t decision;
+    };
+
+    // 决策节点：新方块已放好，轮到玩家移动
+    struct Decision {
+        BitBoard board;
+        uint64_t visits   = 0;
+        int32_t action[4] = {-1, -1, -1, -1};  // 各方向对应的 Action 下标，不能移动为-1
+        bool expanded     = false;
+    };
+
+    // 玩家移动后的 afterstate，同时是随机节点
+    struct Action {
+        BitBoard afterstate = 0;
+        int moveScore       = 0;
+        uint64_t visits     = 0;
+        double total        = 0.0;  // 从这一步开始（含本步合并分数）的回报之和
+        std::vector<Outcome> outcomes;
+    };
+
+    std::vector<Decision> decisions;
+    std::vector<Action> actions;
+
+    uint32_t addDecision(BitBoard board) {
+        decisions.emplace_back();
+        decisions.back().board = board;
+        return static_cast<uint32_t>(decisions.size() - 1);
+    }
+
+    // 展开决策节点的所有可行方向，没有可行方向时返回 false
+    bool expand(uint32_t index) {
+        MoveSet moves = executeAllMoves(decisions[index].board);
+        for (int direction = 0; direction < 4; ++direction) {
+            if (moves.legalMask & (1U << direction)) {
+                actions.emplace_back();
+                actions.back().afterstate          = moves.boards[direction];
+                actions.back().moveScore           = moves.scores[direction];
+                decisions[index].action[direction] = static_cast<int32_t>(actions.size() - 1);
+            }
+        }
+        decisions[index].expanded = true;
+        return moves.legalMask != 0;
+    }
+
+    // UCT 选择方向，没有访问过的方向优先
+    int select(uint32_t index) const {
+        Decision const& decision = decisions[index];
+
+        // 回报没有上界，按这个节点下最大的平均回报归一化
+        double scale = 1.0;
+        for (int direction = 0; direction < 4; ++direction) {
+            if (decision.action[direction] < 0) {
+                continue;
+            }
+            Action const& action = actions[decision.action[direction]];
+            if (action.visits == 0) {
+                return direction;
+            }
+            scale = std::max(scale, action.total / action.visits);
+        }
+
+        double logVisits = std::log(static_cast<double>(decision.visits));
+        int best         = -1;
+        double bestValue = -1.0;
+        for (int direction = 0; direction < 4; ++direction) {
+            if (decision.action[direction] < 0) {
+                continue;
+            }
+            Action const& action = actions[decision.action[direction]];
+            double mean          = action.total / action.visits / scale;
+            double value         = mean + kExploration * std::sqrt(logVisits / action.visits);
+            if (value > bestValue) {
+                bestValue = value;
+                best      = direction;
+            }
+        }
+        return best;
+    }
+
+    // 按概率采样 afterstate 的后继，已经在树中的返回对应节点，否则新建节点
+    // 节点数已达上限时返回-1，并通过 board 返回采样到的棋盘
+    int64_t sampleOutcome(uint32_t actionIndex, FastRandom& random, BitBoard& board) {
+        board = spawnRandomTile(actions[actionIndex].afterstate, random);
+        for (Outcome const& outcome : actions[actionIndex].outcomes) {
+            if (outcome.board == board) {
+                return outcome.decision;
+            }
+        }
+        if (decisions.size() >= kMaxTreeNodes) {
+            return -1;
+        }
+        uint32_t decision = addDecision(board);
+        actions[actionIndex].outcomes.push_back(Outcome{board, decision});
+        return decision;
+    }
+};
+
+}  // namespace
+
+MctsSearcher::MctsSearcher(unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1U, std::thread::hardware_concurrency());
+    }
+    if (threadCount > 1) {
+        pool = std::make_unique<ThreadPool>(threadCount);
+    }
+}
+
+SearchResult MctsSearcher::search(BitBoard board, std::chrono::milliseconds budget) {
+    SearchResult result;
+    MoveSet moves    = executeAllMoves(board);
+    result.legalMask = moves.legalMask;
+    playouts         = 0;
+    if (moves.legalMask == 0) {
+        return result;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + budget;
+    uint64_t seed = randomSeed() ^ (++searchCount) * 0x9E37'79B9'7F4A'7C15ULL ^ board;
+
+    // 每个线程一棵树，各用同一个种子下的一个 stream
+    std::vector<RootStats> stats;
+    if (!pool) {
+        stats.push_back(searchTree(board, deadline, seed, 0));
+    } else {
+        std::vector<std::future<RootStats>> trees;
+        for (unsigned t = 0; t < pool->size(); ++t) {
+            trees.push_back(
+                pool->submit([this, board, deadline, seed, t]() { return searchTree(board, deadline, seed, t); }));
+        }
+        for (std::future<RootStats>& tree : trees) {
+            stats.push_back(tree.get());
+        }
+    }
+
+    // 合并各棵树的根节点统计，选择访问次数最多的方向
+    uint64_t bestVisits = 0;
+    for (RootStats const& tree : stats) {
+        playouts += tree.playouts;
+    }
+    for (int direction = 0; direction < 4; ++direction) {
+        if (!(moves.legalMask & (1U << direction))) {
+            continue;
+        }
+        uint64_t visits = 0;
+        double total    = 0.0;
+        for (RootStats const& tree : stats) {
+            visits += tree.visits[direction];
+            total  += tree.totals[direction];
+        }
+        result.scores[direction] = visits > 0 ? static_cast<int>(total / visits) : 0;
+        if (result.move == -1 || visits > bestVisits) {
+            bestVisits  = visits;
+            result.move = direction;
+        }
+    }
+    result.score = result.move >= 0 ? result.scores[result.move] : 0;
+    return result;
+}
+
+MctsSearcher::RootStats MctsSearcher::searchTree(BitBoard board,
+                                                 std::chrono::steady_clock::time_point deadline,
+                                                 uint64_t seed,
+                                                 uint64_t stream) {
+    FastRandom random(seed, stream);
+    Tree tree;
+    tree.addDecision(board);
+
+    // 一次迭代经过的方向及到达该方向前已累计的分数
+    struct Step {
+        uint32_t decision;
+        int32_t action;
+        double before;
+    };
+    std::vector<Step> path;
+
+    RootStats stats = {};
+    for (uint64_t iteration = 0;; ++iteration) {
+        if (iteration % kDeadlineCheckInterval == 0
+            && (stopRequested.load(std::memory_order_relaxed) || std::chrono::steady_clock::now() >= deadline)) {
+            break;
+        }
+
+        // 选择：沿树向下，直到遇到新节点或没有可行移动的节点
+        path.clear();
+        uint32_t current = 0;
+        double reward    = 0.0;
+        for (;;) {
+            if (!tree.decisions[current].expanded && !tree.expand(current)) {
+                break;  // 游戏结束
+            }
+            int direction = tree.select(current);
+            if (direction < 0) {
+                break;
+            }
+            int32_t actionIndex = tree.decisions[current].action[direction];
+            path.push_back(Step{current, actionIndex, reward});
+            reward += tree.actions[actionIndex].moveScore;
+
+            BitBoard next = 0;
+            int64_t child = tree.sampleOutcome(actionIndex, random, next);
+
+            // 扩展与模拟：新出现的后继（或节点数已满）从这里开始随机走子
+            if (child < 0 || tree.decisions[child].visits == 0) {
+                reward += rollout(next, random);
+                if (child >= 0) {
+                    tree.decisions[child].visits++;
+                }
+                break;
+            }
+            current = static_cast<uint32_t>(child);
+        }
+
+        // 回传：每个方向记录从它开始的回报
+        for (Step const& step : path) {
+            Tree::Action& action = tree.actions[step.action];
+            action.visits++;
+            action.total += reward - step.before;
+            tree.decisions[step.decision].visits++;
+        }
+        if (path.empty()) {
+            tree.decisions[current].visits++;
+        }
+        stats.playouts++;
+    }
+
+    for (int direction = 0; direction < 4; ++direction) {
+        int32_t actionIndex = tree.decisions[0].action[direction];
+        if (actionIndex >= 0) {
+            stats.visits[direction] = tree.actions[actionIndex].visits;
+            stats.totals[direction] = tree.actions[actionIndex].total;
+        }
+    }
+    return stats;
+}
+
+}  // namespace engine2048
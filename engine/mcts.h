@@ -0,0 +1,67 @@
+#ifndef MCTS_H
+#define MCTS_H
+
+#include "bitboard.h"
+#include "searcher.h"
+#include "thread_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace engine2048 {
+
+// 位棋盘上的蒙特卡洛树搜索
+//
+// 决策节点按 UCT 在四个方向（移动后的 afterstate）中选择，afterstate 之后按新方块的概率
+// 随机采样一个后继棋盘（空格均匀、2占90%），新扩展的节点用随机走子模拟到结束或步数上限，
+// 模拟中得到的合并分数作为回报。
+// 采用根并行：每个线程独立建一棵树，时间到后把各棵树根节点上的访问次数相加，选访问最多的方向。
+// 线程之间不共享任何状态，不需要加锁。线程数为1时在调用线程上搜索，不创建线程池。
+// 同一个 MctsSearcher 同一时间只能进行一次搜索，stop() 可以在任意线程调用。
+class MctsSearcher {
+   public:
+    // threadCount 为0时使用硬件线程数
+    explicit MctsSearcher(unsigned threadCount = 0);
+
+    MctsSearcher(MctsSearcher const&)            = delete;
+    MctsSearcher& operator=(MctsSearcher const&) = delete;
+
+    // 在时间预算内搜索，时间预算的含义与 Searcher::searchIterative 相同，便于比较两种引擎
+    // 返回的 scores 为各方向的平均回报，depth 固定为0
+    SearchResult search(BitBoard board, std::chrono::milliseconds budget);
+
+    // 请求正在进行的搜索尽快返回；还没有开始的搜索开始后也会立即返回，直到 clearStop()
+    void stop() { stopRequested.store(true, std::memory_order_relaxed); }
+
+    // 清除停止请求，在发起新的搜索请求时调用，与 Searcher::clearStop 相同
+    void clearStop() { stopRequested.store(false, std::memory_order_relaxed); }
+
+    // 上一次搜索完成的模拟次数（所有线程之和）
+    uint64_t lastPlayouts() const { return playouts; }
+
+    unsigned threadCount() const { return pool ? pool->size() : 1; }
+
+   private:
+    // 一个线程一棵树的搜索结果
+    struct RootStats {
+        uint64_t visits[4];
+        double totals[4];
+        uint64_t playouts;
+    };
+
+    RootStats searchTree(BitBoard board,
+                         std::chrono::steady_clock::time_point deadline,
+                         uint64_t seed,
+                         uint64_t stream);
+
+    std::unique_ptr<ThreadPool> pool;
+    std::atomic<bool> stopRequested{false};
+    uint64_t playouts    = 0;
+    uint64_t searchCount = 0;  // 用于为每次搜索生成不同的随机种子
+};
+
+}  // namespace engine2048
+
+#endif  // MCTS_H
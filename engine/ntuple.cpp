@@ -0,0 +1,152 @@
+#include "ntuple.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace engine2048 {
+
+namespace {
+
+// 权重文件的标识和版本
+char const kFileMagic[4]    = {'N', 'T', 'P', 'L'};
+uint32_t const kFileVersion = 1;
+
+// 读写权重时每次经过缓冲区的个数
+size_t const kIoChunk = 1 << 16;
+
+// 格子在第 s 种对称变换后的位置：s 的低两位为顺时针旋转次数，第三位表示先左右翻转
+int transformCell(int cell, int s) {
+    int row = cell / 4;
+    int col = cell % 4;
+    if (s & 4) {
+        col = 3 - col;
+    }
+    for (int r = 0; r < (s & 3); ++r) {
+        int rotated = 3 - row;
+        row         = col;
+        col         = rotated;
+    }
+    return row * 4 + col;
+}
+
+}  // namespace
+
+std::vector<NTupleNetwork::Tuple> NTupleNetwork::defaultTuples() {
+    return {
+        {0, 1, 2, 3, 4, 5},
+        {4, 5, 6, 7, 8, 9},
+        {0, 1, 2, 4, 5, 6},
+        {4, 5, 6, 8, 9, 10},
+    };
+}
+
+NTupleNetwork::NTupleNetwork(std::vector<Tuple> const& tupleShapes)
+    : tuples(tupleShapes), weights(new Weight[tupleShapes.size() * kWeightsPerTuple]()) {
+    shifts.reserve(tupleShapes.size() * 8 * kTupleSize);
+    for (Tuple const& tuple : tupleShapes) {
+        for (int s = 0; s < 8; ++s) {
+            for (int cell : tuple) {
+                shifts.push_back(static_cast<uint8_t>(transformCell(cell, s) * 4));
+            }
+        }
+    }
+}
+
+float NTupleNetwork::value(BitBoard board) const {
+    float total = 0.0f;
+    for (size_t t = 0; t < tuples.size(); ++t) {
+        for (int s = 0; s < 8; ++s) {
+            total += weights[indexOf(board, t, s)].load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+void NTupleNetwork::update(BitBoard board, float delta) {
+    // 读改写不是原子的，并发时可能丢失其他线程的更新，训练可以容忍
+    for (size_t t = 0; t < tuples.size(); ++t) {
+        for (int s = 0; s < 8; ++s) {
+            Weight& weight = weights[indexOf(board, t, s)];
+            weight.store(weight.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+        }
+    }
+}
+
+std::unique_ptr<NTupleNetwork> NTupleNetwork::load(std::string const& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return nullptr;
+    }
+
+    // 文件头：标识、版本、元组数，然后是各元组的格子，最后是全部权重
+    char magic[4];
+    uint32_t version    = 0;
+    uint32_t tupleCount = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&tupleCount), sizeof(tupleCount));
+    if (!file || std::memcmp(magic, kFileMagic, sizeof(magic)) != 0 || version != kFileVersion || tupleCount == 0
+        || tupleCount > 16) {
+        return nullptr;
+    }
+
+    std::vector<Tuple> tuples(tupleCount);
+    for (Tuple& tuple : tuples) {
+        uint8_t cells[kTupleSize];
+        file.read(reinterpret_cast<char*>(cells), sizeof(cells));
+        for (int k = 0; k < kTupleSize; ++k) {
+            if (cells[k] >= 16) {
+                return nullptr;
+            }
+            tuple[k] = cells[k];
+        }
+    }
+    if (!file) {
+        return nullptr;
+    }
+
+    auto network = std::make_unique<NTupleNetwork>(tuples);
+    std::vector<float> buffer(kIoChunk);
+    for (size_t offset = 0; offset < tupleCount * kWeightsPerTuple; offset += kIoChunk) {
+        file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(kIoChunk * sizeof(float)));
+        if (!file) {
+            return nullptr;
+        }
+        for (size_t i = 0; i < kIoChunk; ++i) {
+            network->weights[offset + i].store(buffer[i], std::memory_order_relaxed);
+        }
+    }
+    return network;
+}
+
+bool NTupleNetwork::save(std::string const& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    uint32_t tupleCount = static_cast<uint32_t>(tuples.size());
+    file.write(kFileMagic, sizeof(kFileMagic));
+    file.write(reinterpret_cast<char const*>(&kFileVersion), sizeof(kFileVersion));
+    file.write(reinterpret_cast<char const*>(&tupleCount), sizeof(tupleCount));
+    for (Tuple const& tuple : tuples) {
+        uint8_t cells[kTupleSize];
+        for (int k = 0; k < kTupleSize; ++k) {
+            cells[k] = static_cast<uint8_t>(tuple[k]);
+        }
+        file.write(reinterpret_cast<char const*>(cells), sizeof(cells));
+    }
+
+    // 训练线程可能仍在写入，保存的是某一时刻附近的快照
+    std::vector<float> buffer(kIoChunk);
+    for (size_t offset = 0; offset < tuples.size() * kWeightsPerTuple && file; offset += kIoChunk) {
+        for (size_t i = 0; i < kIoChunk; ++i) {
+            buffer[i] = weights[offset + i].load(std::memory_order_relaxed);
+        }
+        file.write(reinterpret_cast<char const*>(buffer.data()),
+                   static_cast<std::streamsize>(kIoChunk * sizeof(float)));
+    }
+    return static_cast<bool>(file);
+}
+
+}  // namespace engine2048
@@ -0,0 +1,80 @@
+#ifndef NTUPLE_H
+#define NTUPLE_H
+
+#include "bitboard.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace engine2048 {
+
+// N元组网络价值函数
+//
+// 每个元组取棋盘上固定的6个格子，6个格子的对数值拼成24位下标，在该元组的权重表中查一个值。
+// 每个元组按棋盘的8种对称（旋转、翻转）各取样一次，共用同一张权重表，价值为所有查表结果之和。
+// 权重按元组顺序存放在一个连续的 float 数组中，每个元组 16^6 项（64MB），默认4个元组共256MB。
+// 价值的单位与移动的合并分数相同，表示从该棋盘出发还能得到的分数，可以直接作为搜索的叶节点评估。
+//
+// 权重是 relaxed 原子量，读写编译后与普通 float 相同。多个训练线程可以不加锁地同时 update，
+// 偶尔丢失的更新不影响收敛（Hogwild），同时也允许搜索线程在训练进行时读取。
+class NTupleNetwork {
+   public:
+    static int const kTupleSize = 6;
+    using Tuple                 = std::array<int, kTupleSize>;  // 格子下标 i * 4 + j
+
+    // 默认的4个六元组：两条直线形和两条2×3矩形
+    static std::vector<Tuple> defaultTuples();
+
+    // 权重全为0
+    explicit NTupleNetwork(std::vector<Tuple> const& tupleShapes = defaultTuples());
+
+    NTupleNetwork(NTupleNetwork const&)            = delete;
+    NTupleNetwork& operator=(NTupleNetwork const&) = delete;
+
+    // 棋盘的价值
+    float value(BitBoard board) const;
+
+    // 把 board 用到的每个权重加上 delta，可以在多个线程中同时调用
+    void update(BitBoard board, float delta);
+
+    // 一次求值查表的次数（元组数 × 8种对称），训练时学习率通常除以这个数
+    size_t lookupCount() const { return tuples.size() * 8; }
+
+    // 从文件读取元组和权重，文件格式不对或无法读取时返回 nullptr
+    static std::unique_ptr<NTupleNetwork> load(std::string const& path);
+
+    // 保存元组和权重，失败时返回 false
+    bool save(std::string const& path) const;
+
+    size_t tupleCount() const { return tuples.size(); }
+
+   private:
+    static size_t const kWeightsPerTuple = size_t(1) << (4 * kTupleSize);
+
+    using Weight = std::atomic<float>;
+    static_assert(Weight::is_always_lock_free, "weights must be lock-free for concurrent training");
+
+    // 元组 t 在对称变换 s 下的第 k 个格子的位移（格子下标 * 4）
+    int shift(size_t t, int s, int k) const { return shifts[(t * 8 + s) * kTupleSize + k]; }
+
+    // 元组 t 在对称变换 s 下的权重下标
+    size_t indexOf(BitBoard board, size_t t, int s) const {
+        size_t index = 0;
+        for (int k = 0; k < kTupleSize; ++k) {
+            index |= static_cast<size_t>((board >> shift(t, s, k)) & 0xf) << (4 * k);
+        }
+        return t * kWeightsPerTuple + index;
+    }
+
+    std::vector<Tuple> tuples;
+    std::vector<uint8_t> shifts;  // tuples.size() * 8 * kTupleSize
+    std::unique_ptr<Weight[]> weights;
+};
+
+}  // namespace engine2048
+
+#endif  // NTUPLE_H
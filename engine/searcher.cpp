@@ -0,0 +1,480 @@
+#include "searcher.h"
+
+#include <algorithm>
+#include <climits>
+#include <future>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace engine2048 {
+
+namespace {
+
+// 固定深度搜索的节点深度上限，防止过深递归
+int const kMaxAbsoluteDepth = 5;
+
+// 游戏结束的惩罚分
+int const kGameOverScore = -500000;
+
+// 批量搜索时每个线程一次领取的棋盘数
+size_t const kBatchChunkSize = 16;
+
+// 当前线程因概率过低而直接评估的节点数
+// 子树搜索前后的差值不为0时，子树的分数取决于到达它的概率，不能按深度写入置换表
+thread_local unsigned prunedNodes = 0;
+
+}  // namespace
+
+Searcher::Searcher(unsigned threadCount, size_t tableMegabytes)
+    : transpositionTable(tableMegabytes), depthLimit(kMaxAbsoluteDepth) {
+    if (threadCount == 0) {
+        threadCount = std::max(1U, std::thread::hardware_concurrency());
+    }
+    if (threadCount > 1) {
+        pool = std::make_unique<ThreadPool>(threadCount);
+    }
+}
+
+Searcher::~Searcher() {
+    stopPonder();
+}
+
+SearchResult Searcher::search(BitBoard board, int depth) {
+    stopPonder();
+    timedOut.store(false, std::memory_order_relaxed);
+    hasDeadline = false;
+    transpositionTable.newSearch();
+    return pool ? searchParallel(board, depth) : searchSerial(board, depth);
+}
+
+SearchResult Searcher::searchIterative(BitBoard board, std::chrono::milliseconds budget, int maxDepth) {
+    stopPonder();
+    timedOut.store(false, std::memory_order_relaxed);
+    hasDeadline = true;
+    deadline    = std::chrono::steady_clock::now() + budget;
+    transpositionTable.newSearch();
+
+    // 先按一步评估选出一个方向，保证任何时候都有可用的结果
+    SearchResult best;
+    int bestScore = INT_MIN;
+    MoveSet moves = executeAllMoves(board);
+    for (int direction = 0; direction < 4; ++direction) {
+        if (moves.legalMask & (1U << direction)) {
+            int score              = moves.scores[direction] + evaluate(moves.boards[direction]);
+            best.scores[direction] = score;
+            if (score > bestScore) {
+                bestScore = score;
+                best.move = direction;
+            }
+        }
+    }
+    best.score     = best.move >= 0 ? bestScore : 0;
+    best.legalMask = moves.legalMask;
+
+    // 逐层加深，被中断的那一层结果不完整，直接丢弃
+    int const savedDepthLimit = depthLimit;
+    depthLimit                = std::max(maxDepth, kMaxAbsoluteDepth);
+    for (int depth = 1; depth <= maxDepth && moves.legalMask != 0; ++depth) {
+        SearchResult result = pool ? searchParallel(board, depth) : searchSerial(board, depth);
+        if (stopping()) {
+            break;
+        }
+        best       = result;
+        best.depth = depth;
+    }
+    depthLimit  = savedDepthLimit;
+    hasDeadline = false;
+    return best;
+}
+
+void Searcher::findBestMoves(BitBoard const* boards, size_t count, int* moves, int depth) {
+    stopPonder();
+    timedOut.store(false, std::memory_order_relaxed);
+    hasDeadline = false;
+    transpositionTable.newSearch();
+
+    if (!pool) {
+        for (size_t i = 0; i < count; ++i) {
+            moves[i] = searchSerial(boards[i], depth).move;
+        }
+        return;
+    }
+
+    // 每个线程一个任务，按块领取棋盘，避免每个棋盘提交一次任务的开销
+    std::atomic<size_t> next{0};
+    std::vector<std::future<void>> workers;
+    workers.reserve(pool->size());
+    for (unsigned t = 0; t < pool->size(); ++t) {
+        workers.push_back(pool->submit([this, boards, count, moves, depth, &next]() {
+            for (;;) {
+                size_t begin = next.fetch_add(kBatchChunkSize, std::memory_order_relaxed);
+                if (begin >= count) {
+                    return;
+                }
+                size_t end = std::min(begin + kBatchChunkSize, count);
+                for (size_t i = begin; i < end; ++i) {
+                    moves[i] = searchSerial(boards[i], depth).move;
+                }
+            }
+        }));
+    }
+    for (std::future<void>& worker : workers) {
+        worker.get();
+    }
+}
+
+void Searcher::startPonder(BitBoard afterstate, int maxDepth) {
+    stopPonder();
+    {
+        std::lock_guard<std::mutex> lock(ponderMutex);
+        ponderResults.clear();
+    }
+
+    ponderStopRequested.store(false, std::memory_order_relaxed);
+    timedOut.store(false, std::memory_order_relaxed);
+    hasDeadline = false;
+    transpositionTable.newSearch();
+    depthLimit   = std::max(maxDepth, kMaxAbsoluteDepth);
+    ponderThread = std::thread([this, afterstate, maxDepth]() { ponderLoop(afterstate, maxDepth); });
+}
+
+void Searcher::stopPonder() {
+    if (!ponderThread.joinable()) {
+        return;
+    }
+    ponderStopRequested.store(true, std::memory_order_relaxed);
+    ponderThread.join();
+    depthLimit = kMaxAbsoluteDepth;
+}
+
+bool Searcher::takePonderResult(BitBoard board, SearchResult& result) {
+    std::lock_guard<std::mutex> lock(ponderMutex);
+    auto it = ponderResults.find(board);
+    if (it == ponderResults.end()) {
+        return false;
+    }
+    result = it->second;
+    ponderResults.erase(it);
+    return true;
+}
+
+void Searcher::ponderLoop(BitBoard afterstate, int maxDepth) {
+    // 先排生成2的棋盘（概率0.9），再排生成4的棋盘
+    int cells[16];
+    int emptyCount = emptyCells(afterstate, cells);
+    BitBoard successors[32];
+    for (int i = 0; i < emptyCount; ++i) {
+        successors[i]              = afterstate | (1ULL << (cells[i] * 4));
+        successors[emptyCount + i] = afterstate | (2ULL << (cells[i] * 4));
+    }
+
+    // 按深度逐层推进，任何时刻每个棋盘都有尽量深的结果
+    for (int depth = 1; depth <= maxDepth; ++depth) {
+        for (int i = 0; i < emptyCount * 2; ++i) {
+            SearchResult result = pool ? searchParallel(successors[i], depth) : searchSerial(successors[i], depth);
+            if (stopping()) {
+                return;
+            }
+            result.depth = depth;
+
+            std::lock_guard<std::mutex> lock(ponderMutex);
+            ponderResults[successors[i]] = result;
+        }
+    }
+}
+
+SearchResult Searcher::searchSerial(BitBoard board, int depth) {
+    SearchResult result;
+    int bestScore = INT_MIN;
+    MoveSet moves = executeAllMoves(board);
+    for (int direction = 0; direction < 4; ++direction) {
+        if (!(moves.legalMask & (1U << direction))) {
+            continue;
+        }
+        int score                = moves.scores[direction] + expectimax(moves.boards[direction], depth, false);
+        result.scores[direction] = score;
+        if (score > bestScore) {
+            bestScore   = score;
+            result.move = direction;
+        }
+    }
+    result.score     = result.move >= 0 ? bestScore : 0;
+    result.legalMask = moves.legalMask;
+    return result;
+}
+
+SearchResult Searcher::searchParallel(BitBoard board, int depth) {
+    // 每个方向的第一层随机节点
+    struct RootMove {
+        BitBoard afterstate;
+        bool resolved;  // 已从置换表或终止条件得到分数
+        int value;
+        int depth;  // 调整后的深度，写入置换表时使用
+        int childCount;
+        ChanceChild children[32];
+        std::future<std::pair<int, bool>> childValues[32];  // 分数，子树是否有被概率阈值剪掉的分支
+    };
+
+    MoveSet moves = executeAllMoves(board);
+    std::vector<RootMove> roots(4);
+
+    // 先把所有子任务提交出去，再统一等待结果
+    for (int direction = 0; direction < 4; ++direction) {
+        if (!(moves.legalMask & (1U << direction))) {
+            continue;
+        }
+
+        RootMove& root  = roots[direction];
+        root.afterstate = moves.boards[direction];
+        root.resolved   = transpositionTable.probe(root.afterstate, depth, false, root.value);
+        if (root.resolved) {
+            continue;
+        }
+
+        Node node = prepareNode(root.afterstate, depth, false);
+        if (node.terminal) {
+            root.resolved = true;
+            root.value    = node.value;
+            continue;
+        }
+
+        root.depth      = node.depth;
+        root.childCount = expandChance(root.afterstate, node, root.children);
+        int childDepth  = node.depth - 1;
+        for (int i = 0; i < root.childCount; ++i) {
+            BitBoard child      = root.children[i].board;
+            double probability  = root.children[i].weight;
+            root.childValues[i] = pool->submit([this, child, childDepth, probability]() {
+                unsigned prunedBefore = prunedNodes;
+                int value             = expectimax(child, childDepth, true, probability);
+                return std::make_pair(value, prunedNodes != prunedBefore);
+            });
+        }
+    }
+
+    SearchResult result;
+    int bestScore = INT_MIN;
+    for (int direction = 0; direction < 4; ++direction) {
+        if (!(moves.legalMask & (1U << direction))) {
+            continue;
+        }
+
+        RootMove& root = roots[direction];
+        if (!root.resolved) {
+            bool pruned = false;
+            if (root.childCount == 0) {
+                root.value = evaluate(root.afterstate);
+            } else {
+                double total = 0.0;
+                for (int i = 0; i < root.childCount; ++i) {
+                    std::pair<int, bool> child  = root.childValues[i].get();
+                    total                      += root.children[i].weight * child.first;
+                    pruned                      = pruned || child.second;
+                }
+                root.value = static_cast<int>(total);
+            }
+            if (!pruned && !stopping()) {
+                transpositionTable.store(root.afterstate, root.depth, false, root.value);
+            }
+        }
+
+        int score                = moves.scores[direction] + root.value;
+        result.scores[direction] = score;
+        if (score > bestScore) {
+            bestScore   = score;
+            result.move = direction;
+        }
+    }
+    result.score     = result.move >= 0 ? bestScore : 0;
+    result.legalMask = moves.legalMask;
+    return result;
+}
+
+void Searcher::setChanceMode(ChanceMode chanceMode, double cutoff) {
+    if (chanceMode != mode || cutoff != probabilityCutoff) {
+        mode              = chanceMode;
+        probabilityCutoff = cutoff;
+        transpositionTable.clear();
+    }
+}
+
+void Searcher::setEvaluator(std::shared_ptr<NTupleNetwork const> evaluator) {
+    if (evaluator != network) {
+        network = std::move(evaluator);
+        transpositionTable.clear();
+    }
+}
+
+int Searcher::expectimax(BitBoard board, int depth, bool isMaxPlayer, double probability) {
+    // 搜索被中断后尽快返回，这一层的结果会被丢弃
+    if (aborted()) {
+        return 0;
+    }
+
+    // 按进入时的深度查找，按实际搜索的深度保存：深度被 depthLimit 或空格数截断时，
+    // 结果只代表截断后的深度，不能满足之后更深的查找
+    int cachedScore = 0;
+    if (transpositionTable.probe(board, depth, isMaxPlayer, cachedScore)) {
+        return cachedScore;
+    }
+
+    // 完整展开时，到达概率过低的分支不再搜索，直接评估（结果不代表该深度，不写入置换表）
+    if (mode == ChanceMode::Full && isMaxPlayer && depth > 0 && probability < probabilityCutoff) {
+        ++prunedNodes;
+        return evaluateMaxLeaf(board);
+    }
+    unsigned prunedBefore = prunedNodes;
+
+    Node node = prepareNode(board, depth, isMaxPlayer);
+    int result;
+    if (node.terminal) {
+        result = node.value;
+    } else if (isMaxPlayer) {
+        result = maxNode(board, node, probability);
+    } else {
+        result = chanceNode(board, node, probability);
+    }
+
+    // 中断时子节点的分数不完整，子树中有分支被概率阈值剪掉时分数不代表该深度，都不能写入置换表
+    if (prunedNodes == prunedBefore && !stopping()) {
+        transpositionTable.store(board, node.depth, isMaxPlayer, result);
+    }
+    return result;
+}
+
+bool Searcher::aborted() {
+    if (stopping()) {
+        return true;
+    }
+
+    // 读取时钟的开销较大，每个线程每1024个节点检查一次
+    thread_local unsigned nodeCounter = 0;
+    if (hasDeadline && (++nodeCounter & 1023) == 0 && std::chrono::steady_clock::now() >= deadline) {
+        timedOut.store(true, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+int Searcher::evaluateMaxLeaf(BitBoard board) const {
+    if (!network) {
+        return evaluateBoard(board);
+    }
+
+    MoveSet moves = executeAllMoves(board);
+    if (moves.legalMask == 0) {
+        return kGameOverScore;
+    }
+    int bestScore = INT_MIN;
+    for (int direction = 0; direction < 4; ++direction) {
+        if (moves.legalMask & (1U << direction)) {
+            int score = moves.scores[direction] + static_cast<int>(network->value(moves.boards[direction]));
+            bestScore = std::max(bestScore, score);
+        }
+    }
+    return bestScore;
+}
+
+Searcher::Node Searcher::prepareNode(BitBoard board, int depth, bool isMaxPlayer) const {
+    Node node{false, 0, std::min(depth, depthLimit), 0, 0};
+
+    // 如果到达最大深度，返回评估分数
+    if (node.depth <= 0) {
+        node.terminal = true;
+        node.value    = isMaxPlayer ? evaluateMaxLeaf(board) : evaluate(board);
+        return node;
+    }
+
+    // 游戏结束给予大量惩罚
+    if (isGameOver(board)) {
+        node.terminal = true;
+        node.value    = kGameOverScore;
+        return node;
+    }
+
+    int emptyCount = countEmptyTiles(board);
+    int rank       = maxRank(board);
+    node.maxValue  = rank > 0 ? (1 << rank) : 0;
+
+    // 对于高级棋盘，根据空格数量动态调整搜索深度
+    if (node.maxValue >= 2048) {
+        if (emptyCount <= 4) {
+            node.depth = std::min(node.depth, 3);  // 空格很少时限制深度
+        } else {
+            node.extraDepth = 1;  // 空格较多时增加深度
+        }
+    }
+    return node;
+}
+
+int Searcher::maxNode(BitBoard board, Node const& node, double probability) {
+    int bestScore = -1;
+    MoveSet moves = executeAllMoves(board);
+    for (int direction = 0; direction < 4; ++direction) {
+        if (moves.legalMask & (1U << direction)) {
+            int score = moves.scores[direction]
+                        + expectimax(moves.boards[direction], node.depth - 1 + node.extraDepth, false, probability);
+            bestScore = std::max(bestScore, score);
+        }
+    }
+    return bestScore > 0 ? bestScore : 0;
+}
+
+int Searcher::chanceNode(BitBoard board, Node const& node, double probability) {
+    ChanceChild children[32];
+    int childCount = expandChance(board, node, children);
+
+    // 没有空格时返回评估分数
+    if (childCount == 0) {
+        return evaluate(board);
+    }
+
+    double total = 0.0;
+    for (int i = 0; i < childCount; ++i) {
+        total += children[i].weight
+                 * expectimax(children[i].board, node.depth - 1, true, probability * children[i].weight);
+    }
+    return static_cast<int>(total);
+}
+
+int Searcher::expandChance(BitBoard board, Node const& node, ChanceChild children[32]) const {
+    int cells[16];
+    int emptyCount = emptyCells(board, cells);
+    if (emptyCount == 0) {
+        return 0;
+    }
+
+    int count = 0;
+    if (mode == ChanceMode::Full) {
+        // 每个空格等概率，90%概率生成2，10%概率生成4
+        double cellWeight = 1.0 / emptyCount;
+        for (int i = 0; i < emptyCount; ++i) {
+            int shift         = cells[i] * 4;
+            children[count++] = {board | (1ULL << shift), 0.9 * cellWeight};
+            children[count++] = {board | (2ULL << shift), 0.1 * cellWeight};
+        }
+        return count;
+    }
+
+    // 只模拟前一到两个空格以提高性能，高级棋盘只模拟一个
+    int tilesToSimulate = 1;
+    if (node.maxValue < 2048 && emptyCount > 1) {
+        tilesToSimulate = std::min(2, emptyCount);
+    }
+
+    for (int i = 0; i < tilesToSimulate; ++i) {
+        int shift = cells[i] * 4;
+        if (node.maxValue >= 4096) {
+            // 高级棋盘只考虑生成2的情况
+            children[count++] = {board | (1ULL << shift), 1.0 / tilesToSimulate};
+        } else {
+            // 90%概率生成2，10%概率生成4
+            children[count++] = {board | (1ULL << shift), 0.9 / tilesToSimulate};
+            children[count++] = {board | (2ULL << shift), 0.1 / tilesToSimulate};
+        }
+    }
+    return count;
+}
+
+}  // namespace engine2048
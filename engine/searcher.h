@@ -0,0 +1,161 @@
+#ifndef SEARCHER_H
+#define SEARCHER_H
+
+#include "bitboard.h"
+#include "ntuple.h"
+#include "thread_pool.h"
+#include "transposition_table.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace engine2048 {
+
+// 一次搜索的结果
+struct SearchResult {
+    int move           = -1;                // 最佳方向，没有可行移动时为-1
+    int score          = 0;                 // 最佳方向的分数
+    int scores[4]      = {-1, -1, -1, -1};  // 各方向的分数，不能移动的方向为-1
+    unsigned legalMask = 0;                 // 第 d 位为1表示方向 d 可以移动
+    int depth          = 0;                 // 完整完成的搜索深度
+};
+
+// 随机节点的展开方式
+enum class ChanceMode {
+    Sampled,  // 只展开扫描顺序上的前一到两个空格，速度快但分数有偏差
+    Full,     // 展开所有空格的2和4，累计概率低于阈值的分支直接用评估函数代替
+};
+
+// 位棋盘上的 expectimax 搜索
+//
+// 根节点的四个方向以及每个方向下第一层随机节点的各个子节点作为独立任务分给线程池，
+// 所有线程共享同一张置换表。线程数为1时在调用线程上串行搜索，不创建线程池。
+// 同一个 Searcher 同一时间只能进行一次搜索，stop() 可以在任意线程调用。
+// 停止请求一直有效，直到调用 clearStop()：发起请求的一方先清除，再启动搜索，
+// 这样在搜索真正开始之前发出的 stop() 也不会丢失。
+class Searcher {
+   public:
+    // threadCount 为0时使用硬件线程数
+    explicit Searcher(unsigned threadCount = 0, size_t tableMegabytes = TranspositionTable::kDefaultMegabytes);
+    ~Searcher();
+
+    Searcher(Searcher const&)            = delete;
+    Searcher& operator=(Searcher const&) = delete;
+
+    // 从 board 出发搜索 depth 层（与 Auto 原有的深度约定一致：根节点后的随机节点深度为 depth）
+    SearchResult search(BitBoard board, int depth);
+
+    // 迭代加深：依次搜索1、2、3…层，直到 maxDepth 或用完时间预算
+    // 返回最后一个完整完成的深度的结果；连1层都没完成时返回按一步评估选出的方向（depth 为0）
+    SearchResult searchIterative(BitBoard board, std::chrono::milliseconds budget, int maxDepth);
+
+    // 批量搜索：对 boards 中的 count 个棋盘各搜索 depth 层，最佳方向写入 moves（没有可行移动时为-1）
+    // 棋盘之间并行、单个棋盘在一个线程内串行搜索，所有线程共享置换表，适合离线分析和训练时大批量打分
+    void findBestMoves(BitBoard const* boards, size_t count, int* moves, int depth);
+
+    // 请求正在进行的搜索或预测搜索尽快返回；还没有开始的搜索开始后也会立即返回，直到 clearStop()
+    void stop() { stopRequested.store(true, std::memory_order_relaxed); }
+
+    // 清除停止请求，在发起新的搜索请求时调用，不能与该请求的搜索并发
+    void clearStop() { stopRequested.store(false, std::memory_order_relaxed); }
+
+    // 预测搜索：走子之后、新方块出现之前，在后台线程中对 afterstate 的每一种新方块（空格×{2,4}）
+    // 逐层加深地搜索，直到 maxDepth 或被停止。结果写入置换表，并按棋盘保存供 takePonderResult 取用。
+    // 会先停止上一次预测搜索；search/searchIterative 开始时也会先停止预测搜索
+    void startPonder(BitBoard afterstate, int maxDepth);
+
+    // 停止预测搜索并等待后台线程结束，已经完成的结果仍然保留
+    void stopPonder();
+
+    // 取出预测搜索为 board 完成的结果，没有时返回 false
+    bool takePonderResult(BitBoard board, SearchResult& result);
+
+    // 单个节点的期望分数，可在任意线程调用；probability 为到达该节点的累计概率
+    int expectimax(BitBoard board, int depth, bool isMaxPlayer, double probability = 1.0);
+
+    // 设置随机节点的展开方式，不能在搜索进行时调用
+    // 两种方式的分数不能混用，方式或阈值改变时清空置换表
+    static constexpr double kDefaultProbabilityCutoff = 1e-4;
+    void setChanceMode(ChanceMode chanceMode, double cutoff = kDefaultProbabilityCutoff);
+    ChanceMode chanceMode() const { return mode; }
+
+    // 设置叶节点评估函数：network 为空时使用启发式评估表，否则使用N元组网络的价值
+    // 不能在搜索进行时调用，评估函数改变时清空置换表
+    void setEvaluator(std::shared_ptr<NTupleNetwork const> network);
+
+    TranspositionTable& table() { return transpositionTable; }
+    unsigned threadCount() const { return pool ? pool->size() : 1; }
+
+   private:
+    // 随机节点的一个子节点及其权重
+    struct ChanceChild {
+        BitBoard board;
+        double weight;
+    };
+
+    // 进入节点时的预处理结果
+    struct Node {
+        bool terminal;   // 是否直接返回 value
+        int value;       // terminal 为 true 时的分数
+        int depth;       // 调整后的深度
+        int extraDepth;  // MAX节点子节点的额外深度
+        int maxValue;    // 最大方块的值
+    };
+
+    // 随机节点（afterstate）的叶节点评估
+    int evaluate(BitBoard board) const {
+        return network ? static_cast<int>(network->value(board)) : evaluateBoard(board);
+    }
+
+    // MAX节点（新方块出现后的棋盘）的叶节点评估
+    // N元组网络是 afterstate 的价值函数，不能直接评估这种棋盘：取各方向的合并分数加 afterstate 价值的最大值
+    int evaluateMaxLeaf(BitBoard board) const;
+
+    Node prepareNode(BitBoard board, int depth, bool isMaxPlayer) const;
+    int maxNode(BitBoard board, Node const& node, double probability);
+    int chanceNode(BitBoard board, Node const& node, double probability);
+
+    // 列出随机节点的子节点，返回子节点数，权重之和为1
+    int expandChance(BitBoard board, Node const& node, ChanceChild children[32]) const;
+
+    // 根节点：把各方向的随机子节点分给线程池
+    SearchResult searchParallel(BitBoard board, int depth);
+    SearchResult searchSerial(BitBoard board, int depth);
+
+    // 是否应当放弃当前搜索：收到停止请求，或每隔一段节点检查一次是否超时
+    bool aborted();
+
+    // 是否已经放弃当前搜索，不检查时间
+    bool stopping() const {
+        return stopRequested.load(std::memory_order_relaxed) || ponderStopRequested.load(std::memory_order_relaxed)
+               || timedOut.load(std::memory_order_relaxed);
+    }
+
+    TranspositionTable transpositionTable;
+    std::unique_ptr<ThreadPool> pool;
+
+    std::atomic<bool> stopRequested{false};        // 调用方的停止请求，只由 clearStop() 清除
+    std::atomic<bool> ponderStopRequested{false};  // stopPonder() 的停止请求
+    std::atomic<bool> timedOut{false};             // 当前搜索已超过时间预算
+    bool hasDeadline = false;
+    std::chrono::steady_clock::time_point deadline;
+    int depthLimit;  // 节点深度上限，迭代加深时放宽
+
+    ChanceMode mode          = ChanceMode::Sampled;
+    double probabilityCutoff = kDefaultProbabilityCutoff;
+    std::shared_ptr<NTupleNetwork const> network;
+
+    // 预测搜索
+    void ponderLoop(BitBoard afterstate, int maxDepth);
+    std::thread ponderThread;
+    std::mutex ponderMutex;  // 保护 ponderResults
+    std::unordered_map<BitBoard, SearchResult> ponderResults;
+};
+
+}  // namespace engine2048
+
+#endif  // SEARCHER_H
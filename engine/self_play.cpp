@@ -0,0 +1,395 @@
+#include "self_play.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace engine2048 {
+
+namespace {
+
+// 蛇形模式权重，与 Auto::evaluateWithParams 相同
+int const kSnakePattern[16] = {16, 15, 14, 13, 9, 10, 11, 12, 8, 7, 6, 5, 1, 2, 3, 4};
+
+// 最大方块达到这个对数值（1024）后改用后期评估
+int const kLateGameRank = 10;
+
+// 后期评估中每个 afterstate 采样的空格数，原实现的蒙特卡洛模拟同样只取3个
+int const kLateGameSamples = 3;
+
+// 采样到的棋盘无路可走时的分数
+int const kDeadEndScore = -100000;
+
+// 一条线（行或列）上与参数无关的各项特征，按16位的行值查表
+struct LineFeatures {
+    int emptyCount;
+    int snake[4];  // 这条线作为第 i 行时的蛇形分数
+    int smoothness;
+    int monotonicity;
+    double mergeScore;
+};
+
+LineFeatures computeLineFeatures(unsigned line) {
+    int rank[4];
+    for (int k = 0; k < 4; ++k) {
+        rank[k] = static_cast<int>((line >> (k * 4)) & 0xf);
+    }
+
+    LineFeatures features = {};
+    for (int k = 0; k < 4; ++k) {
+        if (rank[k] == 0) {
+            features.emptyCount++;
+            continue;
+        }
+        // 与原实现一样按格子分别取整
+        for (int row = 0; row < 4; ++row) {
+            features.snake[row] += static_cast<int>((1 << rank[k]) * kSnakePattern[row * 4 + k] * (rank[k] / 11.0));
+        }
+    }
+
+    // 相邻非空格子对数差的惩罚，以及两个方向上不单调程度的较小者
+    int decreasing = 0;
+    int increasing = 0;
+    for (int k = 0; k < 3; ++k) {
+        if (rank[k] > 0 && rank[k + 1] > 0) {
+            features.smoothness -= std::abs(rank[k] - rank[k + 1]) * 2;
+        }
+        if (rank[k] > rank[k + 1]) {
+            decreasing += (rank[k] - rank[k + 1]) * 2;
+        } else {
+            increasing += (rank[k + 1] - rank[k]) * 2;
+        }
+    }
+    features.monotonicity = std::min(decreasing, increasing);
+
+    // 相邻相同方块和 x-2x-4x 递增序列的奖励，对应 Auto::calculateMergeScore 在一条线上的部分
+    for (int k = 0; k < 3; ++k) {
+        if (rank[k] > 0 && rank[k] == rank[k + 1]) {
+            features.mergeScore += (1 << rank[k]) * (rank[k] / 10.0) * 2.0;
+        }
+    }
+    for (int k = 0; k < 2; ++k) {
+        if (rank[k] > 0 && rank[k + 1] == rank[k] + 1 && rank[k + 2] == rank[k] + 2) {
+            features.mergeScore += (1 << rank[k + 2]) * 0.5;
+        }
+    }
+    return features;
+}
+
+// 所有行值的特征，与参数无关，第一次构造 ParamEvaluator 时计算一次
+std::vector<LineFeatures> const& lineFeatures() {
+    static std::vector<LineFeatures> const features = []() {
+        std::vector<LineFeatures> table(65536);
+        for (unsigned line = 0; line < 65536; ++line) {
+            table[line] = computeLineFeatures(line);
+        }
+        return table;
+    }();
+    return features;
+}
+
+// 后期评估：启发式评估加上对新方块采样后再走一步的期望
+int lateGameValue(BitBoard afterstate, FastRandom& random) {
+    int value = evaluateBoard(afterstate);
+
+    int cells[16];
+    int emptyCount = emptyCells(afterstate, cells);
+    if (emptyCount == 0) {
+        return value;
+    }
+
+    int samples     = std::min(emptyCount, kLateGameSamples);
+    double expected = 0.0;
+    for (int sample = 0; sample < samples; ++sample) {
+        int cell = cells[random.below(static_cast<unsigned>(emptyCount))];
+        for (int rank = 1; rank <= 2; ++rank) {
+            MoveSet moves = executeAllMoves(afterstate | (static_cast<BitBoard>(rank) << (cell * 4)));
+            int best      = kDeadEndScore;
+            for (int direction = 0; direction < 4; ++direction) {
+                if (moves.legalMask & (1U << direction)) {
+                    best = std::max(best, moves.scores[direction] + evaluateBoard(moves.boards[direction]));
+                }
+            }
+            expected += (rank == 1 ? 0.9 : 0.1) * best;
+        }
+    }
+    return value + static_cast<int>(expected / samples);
+}
+
+double chanceValue(ParamEvaluator const& evaluator, BitBoard afterstate, int depth);
+
+// 搜索中的走子节点，depth 为0时直接评估
+double maxValue(ParamEvaluator const& evaluator, BitBoard board, int depth) {
+    if (depth <= 0) {
+        return evaluator.evaluate(board);
+    }
+    MoveSet moves = executeAllMoves(board);
+    if (moves.legalMask == 0) {
+        return kDeadEndScore;
+    }
+    double best = kDeadEndScore;
+    for (int direction = 0; direction < 4; ++direction) {
+        if (moves.legalMask & (1U << direction)) {
+            best = std::max(best, moves.scores[direction] + chanceValue(evaluator, moves.boards[direction], depth - 1));
+        }
+    }
+    return best;
+}
+
+// 搜索中的随机节点：afterstate 的每个空格放2（90%）或4（10%）后的期望，depth 为0时直接评估
+double chanceValue(ParamEvaluator const& evaluator, BitBoard afterstate, int depth) {
+    int cells[16];
+    int emptyCount = emptyCells(afterstate, cells);
+    if (depth <= 0 || emptyCount == 0) {
+        return evaluator.evaluate(afterstate);
+    }
+    double expected = 0.0;
+    for (int k = 0; k < emptyCount; ++k) {
+        BitBoard withTwo  = afterstate | (static_cast<BitBoard>(1) << (cells[k] * 4));
+        BitBoard withFour = afterstate | (static_cast<BitBoard>(2) << (cells[k] * 4));
+        expected += 0.9 * maxValue(evaluator, withTwo, depth - 1) + 0.1 * maxValue(evaluator, withFour, depth - 1);
+    }
+    return expected / emptyCount;
+}
+
+}  // namespace
+
+ParamEvaluator::ParamEvaluator(HeuristicParams const& params)
+    : weights(params), rowTables(4 * 65536), columnTable(65536) {
+    std::vector<LineFeatures> const& features = lineFeatures();
+    for (unsigned line = 0; line < 65536; ++line) {
+        LineFeatures const& f = features[line];
+
+        // 行和列共有的部分：平滑度、单调性、合并可能性
+        double shared     = f.smoothness * params[2] - f.monotonicity * params[3] + f.mergeScore * params[4];
+        columnTable[line] = static_cast<float>(shared);
+
+        // 空格和蛇形只在行表中计算一次
+        for (int row = 0; row < 4; ++row) {
+            double value                 = shared + f.emptyCount * params[0] * 10 + f.snake[row] * params[1] / 10;
+            rowTables[row * 65536 + line] = static_cast<float>(value);
+        }
+    }
+}
+
+int ParamEvaluator::evaluate(BitBoard board) const {
+    BitBoard transposed = transpose(board);
+    float total         = 0.0f;
+    for (int k = 0; k < 4; ++k) {
+        total += rowTables[k * 65536 + ((board >> (16 * k)) & 0xffff)];
+        total += columnTable[(transposed >> (16 * k)) & 0xffff];
+    }
+    int score = static_cast<int>(total);
+
+    // 最大方块（有多个时取按行扫描的第一个）在角落的奖励
+    int topRank = maxRank(board);
+    int cell    = 0;
+    while (getTile(board, cell) != topRank) {
+        ++cell;
+    }
+    int row    = cell / 4;
+    int column = cell % 4;
+    if (topRank > 0 && (row == 0 || row == 3) && (column == 0 || column == 3)) {
+        score += (1 << topRank) * 2;
+    }
+    return score;
+}
+
+ParamEvaluator const& SelfPlayContext::evaluatorFor(HeuristicParams const& params) {
+    if (!evaluator || evaluator->params() != params) {
+        evaluator = std::make_unique<ParamEvaluator>(params);
+    }
+    return *evaluator;
+}
+
+SelfPlayContext& SelfPlayContext::forThread() {
+    thread_local SelfPlayContext context;
+    return context;
+}
+
+GameResult playSelfPlayGame(ParamEvaluator const& evaluator, FastRandom& random) {
+    GameResult result = {0, 0, 0};
+    BitBoard board    = spawnRandomTile(spawnRandomTile(0, random), random);
+    int topRank       = maxRank(board);
+
+    while (result.moves < kMaxSelfPlayMoves) {
+        MoveSet moves = executeAllMoves(board);
+        if (moves.legalMask == 0) {
+            break;
+        }
+
+        // 在可行方向中选择 合并分数 + 评估 最大的方向
+        bool lateGame     = topRank >= kLateGameRank;
+        int bestDirection = -1;
+        int bestScore     = 0;
+        for (int direction = 0; direction < 4; ++direction) {
+            if (!(moves.legalMask & (1U << direction))) {
+                continue;
+            }
+            BitBoard afterstate = moves.boards[direction];
+            int value           = lateGame ? lateGameValue(afterstate, random) : evaluator.evaluate(afterstate);
+            int total           = value + moves.scores[direction];
+            if (bestDirection == -1 || total > bestScore) {
+                bestScore     = total;
+                bestDirection = direction;
+            }
+        }
+
+        result.score += moves.scores[bestDirection];
+        result.moves++;
+        board   = spawnRandomTile(moves.boards[bestDirection], random);
+        topRank = std::max(topRank, maxRank(board));
+    }
+
+    result.maxTile = 1 << topRank;
+    return result;
+}
+
+std::vector<GameResult> playSelfPlayGames(ParamEvaluator const& evaluator,
+                                          size_t count,
+                                          uint64_t seed,
+                                          GameFinishedCallback const& onFinished) {
+    std::vector<GameResult> results(count);
+
+    // 进行中的对局，结束的对局移出后后面的对局前移，下标 i 不再等于对局编号 ids[i]
+    std::vector<size_t> ids(count);
+    std::vector<BitBoard> boards(count);
+    std::vector<int> scores(count, 0);
+    std::vector<int> moveCounts(count, 0);
+    std::vector<int> topRanks(count);
+
+    // 新方块和后期评估的采样各用一个随机序列，新方块序列不受走法和评估方式的影响
+    std::vector<FastRandom> spawnRandoms;
+    std::vector<FastRandom> sampleRandoms;
+    spawnRandoms.reserve(count);
+    sampleRandoms.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        spawnRandoms.emplace_back(seed, 2 * i);
+        sampleRandoms.emplace_back(seed, 2 * i + 1);
+        ids[i]      = i;
+        boards[i]   = spawnRandomTile(spawnRandomTile(0, spawnRandoms[i]), spawnRandoms[i]);
+        topRanks[i] = maxRank(boards[i]);
+    }
+
+    // 每局四个方向的 afterstate、合并分数和总评估
+    std::vector<BitBoard> afterstates(count * 4);
+    std::vector<int> moveScores(count * 4);
+    std::vector<int> totals(count * 4);
+    std::vector<unsigned> legalMasks(count);
+
+    size_t active = count;
+    while (active > 0) {
+        // 1. 生成所有对局的移动
+        for (size_t i = 0; i < active; ++i) {
+            MoveSet moves = executeAllMoves(boards[i]);
+            legalMasks[i] = moves.legalMask;
+            for (int direction = 0; direction < 4; ++direction) {
+                afterstates[i * 4 + direction] = moves.boards[direction];
+                moveScores[i * 4 + direction]  = moves.scores[direction];
+            }
+        }
+
+        // 2. 评估所有可行的 afterstate
+        for (size_t i = 0; i < active; ++i) {
+            bool lateGame = topRanks[i] >= kLateGameRank;
+            for (int direction = 0; direction < 4; ++direction) {
+                size_t k = i * 4 + direction;
+                if (!(legalMasks[i] & (1U << direction))) {
+                    continue;
+                }
+                int value = lateGame ? lateGameValue(afterstates[k], sampleRandoms[i])
+                                     : evaluator.evaluate(afterstates[k]);
+                totals[k] = value + moveScores[k];
+            }
+        }
+
+        // 3. 选择方向并放新方块，没有可行方向的对局留到下一趟移出
+        for (size_t i = 0; i < active; ++i) {
+            int bestDirection = -1;
+            for (int direction = 0; direction < 4; ++direction) {
+                if ((legalMasks[i] & (1U << direction))
+                    && (bestDirection == -1 || totals[i * 4 + direction] > totals[i * 4 + bestDirection])) {
+                    bestDirection = direction;
+                }
+            }
+            if (bestDirection == -1) {
+                continue;
+            }
+            size_t k       = i * 4 + bestDirection;
+            scores[i]     += moveScores[k];
+            moveCounts[i] += 1;
+            boards[i]      = spawnRandomTile(afterstates[k], spawnRandoms[i]);
+            topRanks[i]    = std::max(topRanks[i], maxRank(boards[i]));
+        }
+
+        // 4. 移出结束的对局，保持数组紧凑
+        size_t kept = 0;
+        for (size_t i = 0; i < active; ++i) {
+            if (legalMasks[i] == 0 || moveCounts[i] >= kMaxSelfPlayMoves) {
+                GameResult& result = results[ids[i]];
+                result             = GameResult{scores[i], 1 << topRanks[i], moveCounts[i]};
+                if (onFinished) {
+                    onFinished(ids[i], result);
+                }
+                continue;
+            }
+            if (kept != i) {
+                ids[kept]           = ids[i];
+                boards[kept]        = boards[i];
+                scores[kept]        = scores[i];
+                moveCounts[kept]    = moveCounts[i];
+                topRanks[kept]      = topRanks[i];
+                spawnRandoms[kept]  = spawnRandoms[i];
+                sampleRandoms[kept] = sampleRandoms[i];
+            }
+            ++kept;
+        }
+        active = kept;
+    }
+    return results;
+}
+
+std::vector<GameResult> playSearchGames(ParamEvaluator const& evaluator,
+                                        size_t count,
+                                        uint64_t seed,
+                                        int depth,
+                                        GameFinishedCallback const& onFinished) {
+    std::vector<GameResult> results(count);
+    for (size_t i = 0; i < count; ++i) {
+        FastRandom random(seed, 2 * i);
+        GameResult& result = results[i];
+        result             = GameResult{0, 0, 0};
+        BitBoard board     = spawnRandomTile(spawnRandomTile(0, random), random);
+
+        while (result.moves < kMaxSelfPlayMoves) {
+            MoveSet moves = executeAllMoves(board);
+            if (moves.legalMask == 0) {
+                break;
+            }
+
+            int bestDirection = -1;
+            double bestValue  = 0.0;
+            for (int direction = 0; direction < 4; ++direction) {
+                if (!(moves.legalMask & (1U << direction))) {
+                    continue;
+                }
+                double value = moves.scores[direction] + chanceValue(evaluator, moves.boards[direction], depth);
+                if (bestDirection == -1 || value > bestValue) {
+                    bestValue     = value;
+                    bestDirection = direction;
+                }
+            }
+
+            result.score += moves.scores[bestDirection];
+            result.moves++;
+            board = spawnRandomTile(moves.boards[bestDirection], random);
+        }
+
+        result.maxTile = 1 << maxRank(board);
+        if (onFinished) {
+            onFinished(i, result);
+        }
+    }
+    return results;
+}
+
+}  // namespace engine2048
@@ -0,0 +1,100 @@
+#ifndef SELF_PLAY_H
+#define SELF_PLAY_H
+
+#include "bitboard.h"
+#include "fast_random.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace engine2048 {
+
+// 参数化评估的5个权重：空格、蛇形、平滑度、单调性、合并可能性，含义与 Auto::evaluateWithParams 相同
+using HeuristicParams = std::array<double, 5>;
+
+// 按一组参数预先算好行表的参数化评估，含义与 Auto::evaluateWithParams 相同
+//
+// 空格、蛇形、平滑度、单调性和合并可能性都可以按行、列分解：构造时把参数加权后的每行取值
+// 填进 4 张行表（蛇形权重按行不同）和 1 张列表，评估时每行、每列各查一次表，
+// 再单独加上最大方块在角落的奖励，与 heur_score_table 的用法相同。
+// 原实现对每一项分别取整，这里各项相加后才取整，结果只相差取整误差。
+// 构造需要填表（约 1.3MB），同一组参数应复用同一个实例；构造后只读，可以在多个线程中共用。
+class ParamEvaluator {
+   public:
+    explicit ParamEvaluator(HeuristicParams const& params);
+
+    int evaluate(BitBoard board) const;
+
+    HeuristicParams const& params() const { return weights; }
+
+   private:
+    HeuristicParams weights;
+    std::vector<float> rowTables;    // 4 × 65536，第 i 张对应第 i 行
+    std::vector<float> columnTable;  // 65536，转置后的每一行（即原来的列）共用
+};
+
+// 训练线程复用的自我对弈上下文：保存最近使用的一组参数的评估表，同一线程连续评估同一组参数时不重复填表
+//
+// 不依赖 Qt，析构时只释放评估表，可以作为线程池线程的 thread_local 变量，随线程退出销毁。
+struct SelfPlayContext {
+    std::unique_ptr<ParamEvaluator> evaluator;
+
+    // params 的评估表，参数与上一次不同时重建
+    ParamEvaluator const& evaluatorFor(HeuristicParams const& params);
+
+    // 当前线程的上下文，第一次调用时创建
+    static SelfPlayContext& forThread();
+};
+
+// 一局自我对弈的结果
+struct GameResult {
+    int score;    // 累计合并分数
+    int maxTile;  // 最大方块的值（不是对数）
+    int moves;    // 走了多少步
+};
+
+// 训练用的自我对弈，对应 Auto::simulateFullGameDetailed
+//
+// 从两个随机方块开始，每步在可行方向中选 合并分数 + 评估 最大的一个，最多走 kMaxSelfPlayMoves 步。
+// 最大方块不到1024时用 evaluator 做参数化评估；之后改用固定的启发式评估，
+// 再加上对新方块采样的一层前瞻，与原实现在后期改用高级评估加蒙特卡洛模拟的做法对应。
+// 整局只在位棋盘上计算，不分配内存。random 由调用方持有，不同线程使用不同实例。
+int const kMaxSelfPlayMoves = 2000;
+GameResult playSelfPlayGame(ParamEvaluator const& evaluator, FastRandom& random);
+
+// 批量自我对弈中每局结束时的回调，game 为对局的下标
+using GameFinishedCallback = std::function<void(size_t game, GameResult const& result)>;
+
+// 用同一组参数下 count 局，所有对局按步同时推进，每局的走法与 playSelfPlayGame 相同
+//
+// 进行中的对局的棋盘、分数、步数和随机数状态各自存放在连续数组中，每一步分几趟遍历整个批次：
+// 生成四个方向的移动、评估所有 afterstate、选择方向并放新方块，最后把结束的对局移出数组。
+// 相邻对局之间没有依赖，查表可以重叠执行，executeAllMoves 的 AVX2 路径也连续作用在同一段数据上。
+// 第 i 局的新方块使用 FastRandom(seed, 2i)，后期评估的采样使用 FastRandom(seed, 2i + 1)，结果只由 seed 决定。
+// 新方块的随机序列不受走法影响，不同参数用同一个 seed 时面对同一串随机数（共用随机数）。
+// onFinished 按结束的先后在调用线程上调用。
+std::vector<GameResult> playSelfPlayGames(ParamEvaluator const& evaluator,
+                                          size_t count,
+                                          uint64_t seed,
+                                          GameFinishedCallback const& onFinished = nullptr);
+
+// 按 expectimax 搜索走子的自我对弈，用于多精度评估：深度越小越便宜，排序与高精度评估大体一致
+//
+// depth 与 Auto::expectimax 的约定相同，是走子之后随机节点的深度：0 为一步贪心（合并分数 + 评估），
+// 2 为 走子-新方块-走子，3 为 Auto::findBestMove 使用的深度（再放一次新方块，评估放好新方块的棋盘）。
+// 随机节点展开所有空格的2和4，整局都用 evaluator 评估，没有 playSelfPlayGame 的后期评估。
+// 搜索本身没有随机性，第 i 局的新方块使用 FastRandom(seed, 2i)，与 playSelfPlayGames 的新方块序列相同。
+// 各局依次在调用线程上进行，onFinished 在每局结束时调用。
+std::vector<GameResult> playSearchGames(ParamEvaluator const& evaluator,
+                                        size_t count,
+                                        uint64_t seed,
+                                        int depth,
+                                        GameFinishedCallback const& onFinished = nullptr);
+
+}  // namespace engine2048
+
+#endif  // SELF_PLAY_H
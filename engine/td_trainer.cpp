@@ -0,0 +1,132 @@
+#include "td_trainer.h"
+
+#include "fast_random.h"
+
+#include <future>
+#include <utility>
+#include <vector>
+
+namespace engine2048 {
+
+TdTrainer::TdTrainer(std::shared_ptr<NTupleNetwork> trainedNetwork, unsigned threadCount)
+    : network(std::move(trainedNetwork)), pool(threadCount) {}
+
+uint64_t TdTrainer::train(uint64_t games,
+                          Options const& options,
+                          ProgressCallback const& report,
+                          std::chrono::milliseconds reportInterval) {
+    stopRequested.store(false, std::memory_order_relaxed);
+    gamesClaimed.store(0, std::memory_order_relaxed);
+    gamesFinished.store(0, std::memory_order_relaxed);
+    windowGames.store(0, std::memory_order_relaxed);
+    windowScore.store(0, std::memory_order_relaxed);
+    windowMaxRank.store(0, std::memory_order_relaxed);
+
+    std::vector<std::future<void>> workers;
+    for (unsigned t = 0; t < pool.size(); ++t) {
+        workers.push_back(pool.submit([this, games, options, t]() { worker(games, options, t); }));
+    }
+
+    // 汇总报告间隔内的统计并清零
+    auto windowStart = std::chrono::steady_clock::now();
+    auto collect     = [this, &windowStart]() {
+        auto now       = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - windowStart).count();
+        windowStart    = now;
+
+        uint64_t count = windowGames.exchange(0, std::memory_order_relaxed);
+        uint64_t score = windowScore.exchange(0, std::memory_order_relaxed);
+        int rank       = windowMaxRank.exchange(0, std::memory_order_relaxed);
+
+        Progress progress;
+        progress.games          = gamesFinished.load(std::memory_order_relaxed);
+        progress.gamesPerSecond = seconds > 0.0 ? count / seconds : 0.0;
+        progress.averageScore   = count > 0 ? static_cast<double>(score) / count : 0.0;
+        progress.maxTile        = rank > 0 ? (1 << rank) : 0;
+        return progress;
+    };
+
+    // 等待工作线程的同时按间隔报告进度
+    size_t finished = 0;
+    while (finished < workers.size()) {
+        if (workers[finished].wait_until(windowStart + reportInterval) == std::future_status::ready) {
+            workers[finished++].get();
+            continue;
+        }
+        if (report && !report(collect())) {
+            stop();
+        }
+    }
+
+    // 最后一个不完整的间隔
+    if (report) {
+        report(collect());
+    }
+    return gamesFinished.load(std::memory_order_relaxed);
+}
+
+void TdTrainer::worker(uint64_t games, Options const& options, uint64_t stream) {
+    FastRandom random(options.seed, stream);
+    float const step   = static_cast<float>(options.learningRate / network->lookupCount());
+    float const lambda = static_cast<float>(options.lambda);
+
+    // 一局中每一步的 afterstate 和得到它的合并分数
+    std::vector<BitBoard> afterstates;
+    std::vector<int> rewards;
+
+    while (!stopRequested.load(std::memory_order_relaxed)
+           && gamesClaimed.fetch_add(1, std::memory_order_relaxed) < games) {
+        afterstates.clear();
+        rewards.clear();
+
+        // 自我对弈：按合并分数加 afterstate 价值贪心走子
+        BitBoard board = spawnRandomTile(spawnRandomTile(0, random), random);
+        uint64_t score = 0;
+        for (;;) {
+            MoveSet moves = executeAllMoves(board);
+            if (moves.legalMask == 0) {
+                break;
+            }
+
+            int best        = -1;
+            float bestValue = 0.0f;
+            for (int direction = 0; direction < 4; ++direction) {
+                if (!(moves.legalMask & (1U << direction))) {
+                    continue;
+                }
+                float value = moves.scores[direction] + network->value(moves.boards[direction]);
+                if (best == -1 || value > bestValue) {
+                    best      = direction;
+                    bestValue = value;
+                }
+            }
+
+            afterstates.push_back(moves.boards[best]);
+            rewards.push_back(moves.scores[best]);
+            score += moves.scores[best];
+            board  = spawnRandomTile(moves.boards[best], random);
+        }
+
+        // 倒序计算 λ 回报并更新，最后一个 afterstate 之后游戏结束，回报为0
+        float target = 0.0f;
+        for (size_t t = afterstates.size(); t-- > 0;) {
+            float value = network->value(afterstates[t]);
+            float error = target - value;
+            network->update(afterstates[t], step * error);
+
+            // 更新后的价值按步长推算，不再重新查表
+            float updated = value + static_cast<float>(options.learningRate) * error;
+            target        = rewards[t] + (1.0f - lambda) * updated + lambda * target;
+        }
+
+        windowGames.fetch_add(1, std::memory_order_relaxed);
+        windowScore.fetch_add(score, std::memory_order_relaxed);
+        int rank    = maxRank(board);
+        int current = windowMaxRank.load(std::memory_order_relaxed);
+        while (rank > current && !windowMaxRank.compare_exchange_weak(current, rank, std::memory_order_relaxed)) {
+        }
+        gamesFinished.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace engine2048
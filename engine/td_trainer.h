@@ -0,0 +1,71 @@
+#ifndef TD_TRAINER_H
+#define TD_TRAINER_H
+
+#include "ntuple.h"
+#include "thread_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace engine2048 {
+
+// 时间差分自我对弈训练器，学习 N 元组网络的 afterstate 价值
+//
+// 每局按 argmax(合并分数 + V(afterstate)) 贪心走子，新方块的随机性本身提供探索。
+// 一局结束后沿轨迹倒序计算 λ 回报并更新：G_t = r_{t+1} + (1-λ)V(s_{t+1}) + λG_{t+1}，
+// 最后一个 afterstate 的回报为0。λ 为0时就是 TD(0)。
+// 所有工作线程共享同一个网络，按 Hogwild 方式不加锁地写入权重。
+class TdTrainer {
+   public:
+    struct Options {
+        double learningRate = 0.1;  // 每次更新的总步长，会平均分到各个查表项上
+        double lambda       = 0.0;  // λ 回报的衰减系数
+        uint64_t seed       = 1;    // 第 i 个线程使用 FastRandom(seed, i)
+    };
+
+    // 训练进度，在调用 train 的线程上按固定间隔报告
+    struct Progress {
+        uint64_t games;         // 已完成的局数
+        double gamesPerSecond;  // 最近一个报告间隔内的速度
+        double averageScore;    // 最近一个报告间隔内完成的对局的平均分
+        int maxTile;            // 最近一个报告间隔内出现的最大方块
+    };
+
+    // 返回 false 时停止训练
+    using ProgressCallback = std::function<bool(Progress const&)>;
+
+    // threadCount 为0时使用硬件线程数
+    explicit TdTrainer(std::shared_ptr<NTupleNetwork> trainedNetwork, unsigned threadCount = 0);
+
+    // 训练 games 局或直到回调返回 false，每隔 reportInterval 调用一次 report，返回实际完成的局数
+    uint64_t train(uint64_t games,
+                   Options const& options,
+                   ProgressCallback const& report,
+                   std::chrono::milliseconds reportInterval = std::chrono::milliseconds(1000));
+
+    // 请求 train 尽快返回，可以在任意线程调用
+    void stop() { stopRequested.store(true, std::memory_order_relaxed); }
+
+   private:
+    // 在一个工作线程上不断领取对局直到完成或停止
+    void worker(uint64_t games, Options const& options, uint64_t stream);
+
+    std::shared_ptr<NTupleNetwork> network;
+    ThreadPool pool;
+
+    std::atomic<bool> stopRequested{false};
+    std::atomic<uint64_t> gamesClaimed{0};
+
+    // 报告间隔内的统计，由工作线程累加、报告时清零
+    std::atomic<uint64_t> gamesFinished{0};
+    std::atomic<uint64_t> windowGames{0};
+    std::atomic<uint64_t> windowScore{0};
+    std::atomic<int> windowMaxRank{0};
+};
+
+}  // namespace engine2048
+
+#endif  // TD_TRAINER_H
@@ -0,0 +1,122 @@
+#include "transposition_table.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace engine2048 {
+
+namespace {
+
+// splitmix64 的混合函数，把相近的棋盘打散到不同的桶
+inline uint64_t mixBoard(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF'58'47'6D'1C'E4'E5'B9ULL;
+    x = (x ^ (x >> 27)) * 0x94'D0'49'BB'13'31'11'EBULL;
+    return x ^ (x >> 31);
+}
+
+// 同一棋盘作为MAX节点和CHANCE节点时放入不同的桶
+uint64_t const kChanceNodeSalt = 0x9E'37'79'B9'7F'4A'7C'15ULL;
+
+}  // namespace
+
+TranspositionTable::TranspositionTable(size_t megabytes) {
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(size_t megabytes) {
+    size_t budget = std::max<size_t>(megabytes, 1) * 1024 * 1024;
+    size_t count  = 1;
+    while (count * 2 * sizeof(Bucket) <= budget) {
+        count *= 2;
+    }
+
+    buckets.reset(new Bucket[count]);
+    bucketCount = count;
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i < bucketCount; ++i) {
+        for (Entry& entry : buckets[i].entries) {
+            entry.check.store(0, std::memory_order_relaxed);
+            entry.data.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+uint64_t TranspositionTable::pack(int depth, bool isMaxPlayer, int value) const {
+    auto clampedDepth = static_cast<uint64_t>(std::clamp(depth, 0, 255));
+    return static_cast<uint64_t>(static_cast<uint32_t>(value)) | (clampedDepth << 32)
+           | (static_cast<uint64_t>(isMaxPlayer) << 40) | (1ULL << 41) | (static_cast<uint64_t>(generation) << 42);
+}
+
+TranspositionTable::Bucket& TranspositionTable::bucketFor(BitBoard board, bool isMaxPlayer) const {
+    uint64_t hash = mixBoard(isMaxPlayer ? board : board ^ kChanceNodeSalt);
+    return buckets[hash & (bucketCount - 1)];
+}
+
+bool TranspositionTable::probe(BitBoard board, int depth, bool isMaxPlayer, int& value) {
+    for (Entry& entry : bucketFor(board, isMaxPlayer).entries) {
+        uint64_t data  = entry.data.load(std::memory_order_relaxed);
+        uint64_t check = entry.check.load(std::memory_order_relaxed);
+        if (!isValid(data) || (check ^ data) != board || unpackIsMax(data) != isMaxPlayer) {
+            continue;
+        }
+        if (unpackDepth(data) < depth) {
+            return false;
+        }
+
+        // 仍被使用的旧表项转为当前世代，避免被优先淘汰
+        if (unpackGeneration(data) != generation) {
+            refresh(entry, board, data);
+        }
+        value = unpackValue(data);
+        return true;
+    }
+    return false;
+}
+
+void TranspositionTable::store(BitBoard board, int depth, bool isMaxPlayer, int value) {
+    Bucket& bucket   = bucketFor(board, isMaxPlayer);
+    uint64_t newData = pack(depth, isMaxPlayer, value);
+
+    Entry* victim   = nullptr;
+    int victimWorth = INT_MAX;
+    for (Entry& entry : bucket.entries) {
+        uint64_t data  = entry.data.load(std::memory_order_relaxed);
+        uint64_t check = entry.check.load(std::memory_order_relaxed);
+
+        if (isValid(data) && (check ^ data) == board && unpackIsMax(data) == isMaxPlayer) {
+            // 已有同一局面更深的结果时保留原表项
+            if (unpackDepth(data) > depth) {
+                if (unpackGeneration(data) != generation) {
+                    refresh(entry, board, data);
+                }
+                return;
+            }
+            victim = &entry;
+            break;
+        }
+
+        // 空表项最先被使用，其次是旧世代的表项，同一世代中淘汰深度最浅的
+        int worth = -1;
+        if (isValid(data)) {
+            worth = unpackDepth(data) + (unpackGeneration(data) == generation ? 256 : 0);
+        }
+        if (worth < victimWorth) {
+            victim      = &entry;
+            victimWorth = worth;
+        }
+    }
+
+    victim->check.store(board ^ newData, std::memory_order_relaxed);
+    victim->data.store(newData, std::memory_order_relaxed);
+}
+
+void TranspositionTable::refresh(Entry& entry, BitBoard board, uint64_t data) const {
+    uint64_t refreshed = (data & ~kGenerationMask) | (static_cast<uint64_t>(generation) << 42);
+    entry.check.store(board ^ refreshed, std::memory_order_relaxed);
+    entry.data.store(refreshed, std::memory_order_relaxed);
+}
+
+}  // namespace engine2048
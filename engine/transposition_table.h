@@ -0,0 +1,82 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include "bitboard.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace engine2048 {
+
+// 置换表：固定大小、按缓存行分桶，可由多个搜索线程无锁共享
+//
+// 每个桶占一条64字节的缓存行，存放4个表项。表项由两个64位原子量组成：
+// 一个是打包后的数据，另一个是棋盘与数据的异或。读取时重新异或，结果与棋盘一致才算命中，
+// 因此两个字段被其他线程交错写入时只会表现为未命中，不需要加锁。
+// 棋盘本身只有64位，表项中保存的是完整棋盘，不存在哈希碰撞导致的误命中。
+//
+// 表项的值只取决于局面和搜索深度，换了根局面仍然有效，因此表在走子之间不清空。
+// 每次搜索开始时调用 newSearch() 推进世代，替换时优先淘汰旧世代的表项。
+class TranspositionTable {
+   public:
+    static size_t const kDefaultMegabytes = 64;
+
+    TranspositionTable() = default;
+    explicit TranspositionTable(size_t megabytes);
+
+    TranspositionTable(TranspositionTable const&)            = delete;
+    TranspositionTable& operator=(TranspositionTable const&) = delete;
+
+    // 按内存预算（MB）重新分配并清空，实际大小向下取整到2的幂
+    // 不能与 probe/store 并发调用
+    void resize(size_t megabytes);
+
+    // 清空所有表项，不能与 probe/store 并发调用
+    void clear();
+
+    // 开始新一次搜索，之前写入的表项成为旧世代，不能与 probe/store 并发调用
+    void newSearch() { generation = (generation + 1) & 0xff; }
+
+    bool empty() const { return bucketCount == 0; }
+    size_t sizeInBytes() const { return bucketCount * sizeof(Bucket); }
+
+    // 查找搜索深度不低于 depth 的结果，命中时通过 value 返回，并把表项标记为当前世代
+    bool probe(BitBoard board, int depth, bool isMaxPlayer, int& value);
+
+    // 保存搜索结果：同一局面深度更深的结果优先；桶满时先替换旧世代的表项，再替换深度最浅的表项
+    void store(BitBoard board, int depth, bool isMaxPlayer, int value);
+
+   private:
+    struct Entry {
+        std::atomic<uint64_t> check;  // 棋盘 ^ data
+        std::atomic<uint64_t> data;   // 打包的 value/depth/isMaxPlayer/generation
+    };
+
+    struct alignas(64) Bucket {
+        Entry entries[4];
+    };
+
+    // data 的位布局：[0,32) 分值，[32,40) 深度，40 是否为MAX节点，41 有效位，[42,50) 世代
+    static uint64_t const kGenerationMask = 0xffULL << 42;
+    uint64_t pack(int depth, bool isMaxPlayer, int value) const;
+    static int unpackValue(uint64_t data) { return static_cast<int32_t>(static_cast<uint32_t>(data)); }
+    static int unpackDepth(uint64_t data) { return static_cast<int>((data >> 32) & 0xff); }
+    static bool unpackIsMax(uint64_t data) { return ((data >> 40) & 1) != 0; }
+    static bool isValid(uint64_t data) { return ((data >> 41) & 1) != 0; }
+    static unsigned unpackGeneration(uint64_t data) { return static_cast<unsigned>((data >> 42) & 0xff); }
+
+    Bucket& bucketFor(BitBoard board, bool isMaxPlayer) const;
+
+    // 把表项改写为当前世代
+    void refresh(Entry& entry, BitBoard board, uint64_t data) const;
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t bucketCount  = 0;
+    unsigned generation = 0;
+};
+
+}  // namespace engine2048
+
+#endif  // TRANSPOSITION_TABLE_H
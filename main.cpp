@@ -1,10 +1,34 @@
+#include "fast_random.h"
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    // 随机数种子：--seed 优先，其次是环境变量 GAME2048_SEED，都没有时取系统随机数
+    // 必须在创建任何随机数生成器之前设置；启动时打印实际使用的种子，用同一个种子启动即可复现训练
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption seedOption("seed", "Random seed for the AI and training.", "n");
+    parser.addOption(seedOption);
+    parser.process(a);
+
+    QString seedText = parser.isSet(seedOption) ? parser.value(seedOption) : qEnvironmentVariable("GAME2048_SEED");
+    if (!seedText.isEmpty()) {
+        bool valid   = false;
+        quint64 seed = seedText.toULongLong(&valid, 0);
+        if (valid) {
+            engine2048::setRandomSeed(seed);
+        } else {
+            qWarning() << "Ignoring invalid random seed" << seedText;
+        }
+    }
+    qDebug() << "Random seed:" << engine2048::randomSeed();
+
     MainWindow w;
     w.show();
     return a.exec();
@@ -3,11 +3,13 @@
 #include "auto.h"
 #include "ui_mainwindow.h"
 
-// Bitboard implementation is included directly in auto.cpp
+// Bitboard implementation lives in the engine2048 library (engine/)
 
 #include <QCheckBox>
+#include <QComboBox>
 #include <QDebug>
 #include <QDialog>
+#include <QDoubleSpinBox>
 #include <QGridLayout>
 #include <QGroupBox>
 #include <QHBoxLayout>
@@ -29,6 +31,9 @@
 namespace {
 // 新增静态变量，用于记录是否已弹出胜利提示
 bool winAlertShown = false;
+
+// 自动操作时每一步的搜索时间预算（毫秒），高级棋盘在预算内尽量搜索得更深
+int const AI_TIME_BUDGET_MS = 500;
 }  // namespace
 
 // 构造函数：初始化UI、棋盘和标签，并开始新游戏
@@ -57,7 +62,7 @@ MainWindow::MainWindow(QWidget* parent)
     autoPlayTimer->setInterval(300);  // 设置定时器间隔为300毫秒
     connect(autoPlayTimer, &QTimer::timeout, this, &MainWindow::autoPlayStep);
 
-    // 设置AI超时定时器
+    // 设置AI超时定时器：搜索本身按 AI_TIME_BUDGET_MS 返回，这里只是兜底
     aiTimeoutTimer->setInterval(2000);    // 2秒超时
     aiTimeoutTimer->setSingleShot(true);  // 单次触发
     connect(aiTimeoutTimer, &QTimer::timeout, this, &MainWindow::onAiCalculationTimeout);
@@ -181,9 +186,78 @@ void MainWindow::on_undoButton_clicked() {
     }
 }
 
-// on_settingsButton_clicked: 设置按钮的槽函数，显示简单的信息对话框
+// on_settingsButton_clicked: 设置按钮的槽函数，显示AI搜索设置对话框
 void MainWindow::on_settingsButton_clicked() {
-    QMessageBox::information(this, "Settings", "Settings dialog will be implemented here.");
+    QDialog* settingsDialog = new QDialog(this);
+    settingsDialog->setWindowTitle("AI Search Settings");
+    settingsDialog->setMinimumSize(300, 150);
+    settingsDialog->setWindowFlags(settingsDialog->windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    // 随机节点展开方式：完整展开更准确，采样更快
+    QCheckBox* fullEnumerationCheckBox = new QCheckBox("Expand every spawn position", settingsDialog);
+    fullEnumerationCheckBox->setChecked(autoPlayer->getFullChanceEnumeration());
+    fullEnumerationCheckBox->setToolTip("Search all empty cells with both 2 and 4 instead of sampling 1-2 cells");
+
+    QLabel* cutoffLabel           = new QLabel("Probability cutoff:", settingsDialog);
+    QDoubleSpinBox* cutoffSpinBox = new QDoubleSpinBox(settingsDialog);
+    cutoffSpinBox->setDecimals(6);
+    cutoffSpinBox->setRange(0.0, 0.01);
+    cutoffSpinBox->setSingleStep(0.0001);
+    cutoffSpinBox->setValue(autoPlayer->getChanceProbabilityCutoff());
+    cutoffSpinBox->setEnabled(fullEnumerationCheckBox->isChecked());
+    cutoffSpinBox->setToolTip("Branches reached with a lower cumulative probability are evaluated instead of searched");
+    connect(fullEnumerationCheckBox, &QCheckBox::toggled, cutoffSpinBox, &QDoubleSpinBox::setEnabled);
+
+    // 限时搜索使用的引擎，两者的时间预算相同
+    QCheckBox* mctsCheckBox = new QCheckBox("Use Monte Carlo tree search", settingsDialog);
+    mctsCheckBox->setChecked(autoPlayer->getUseMonteCarloTreeSearch());
+    mctsCheckBox->setToolTip("Search high-level boards with MCTS instead of expectimax in the same time budget");
+
+    // 叶节点评估函数，勾选时读取N元组网络的权重文件
+    QCheckBox* ntupleCheckBox = new QCheckBox("Evaluate leaves with the n-tuple network", settingsDialog);
+    ntupleCheckBox->setChecked(autoPlayer->getUseNTupleEvaluator());
+    ntupleCheckBox->setToolTip("Use the trained n-tuple network instead of the handcrafted heuristic");
+
+    // 创建按钮
+    QPushButton* okButton     = new QPushButton("OK", settingsDialog);
+    QPushButton* cancelButton = new QPushButton("Cancel", settingsDialog);
+
+    // 布局
+    QGridLayout* gridLayout = new QGridLayout();
+    gridLayout->addWidget(cutoffLabel, 0, 0);
+    gridLayout->addWidget(cutoffSpinBox, 0, 1);
+
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    buttonLayout->addWidget(cancelButton);
+    buttonLayout->addWidget(okButton);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(settingsDialog);
+    mainLayout->addWidget(fullEnumerationCheckBox);
+    mainLayout->addLayout(gridLayout);
+    mainLayout->addWidget(mctsCheckBox);
+    mainLayout->addWidget(ntupleCheckBox);
+    mainLayout->addLayout(buttonLayout);
+
+    connect(cancelButton, &QPushButton::clicked, settingsDialog, &QDialog::reject);
+    connect(okButton, &QPushButton::clicked, settingsDialog, &QDialog::accept);
+
+    // 设置在下一次搜索开始时生效
+    if (settingsDialog->exec() == QDialog::Accepted) {
+        autoPlayer->setChanceEnumeration(fullEnumerationCheckBox->isChecked(), cutoffSpinBox->value());
+        autoPlayer->setUseMonteCarloTreeSearch(mctsCheckBox->isChecked());
+
+        // 从关闭切换到打开时才读取权重文件
+        bool useNTuple = ntupleCheckBox->isChecked();
+        if (useNTuple && !autoPlayer->getUseNTupleEvaluator() && !autoPlayer->loadNTupleNetwork()) {
+            QMessageBox::warning(this, "N-tuple Network", "Failed to load the n-tuple weights, using the heuristic");
+            useNTuple = false;
+        }
+        autoPlayer->setUseNTupleEvaluator(useNTuple);
+        updateStatus(fullEnumerationCheckBox->isChecked() ? "AI expands every spawn position"
+                                                          : "AI samples spawn positions");
+    }
+
+    settingsDialog->deleteLater();
 }
 
 // keyPressEvent: 重写键盘按下事件函数，响应上下左右键操作
@@ -1115,8 +1189,9 @@ void MainWindow::on_autoPlayButton_clicked() {
         // 停止定时器
         autoPlayTimer->stop();
 
-        // 停止超时定时器
+        // 停止超时定时器和正在进行的搜索
         aiTimeoutTimer->stop();
+        autoPlayer->stopSearch();
 
         // 重置计算状态
         QMutexLocker locker(&aiMutex);
@@ -1184,6 +1259,9 @@ void MainWindow::autoPlayStep() {
 
         // 如果移动成功，生成新的数字块
         if (moved) {
+            // 新方块出现前的空档里提前搜索下一步
+            autoPlayer->startPonder(board);
+
             // 如果有动画正在进行，等待所有动画完成后再生成新方块
             if (pendingAnimations > 0) {
                 animationInProgress = true;
@@ -1288,6 +1366,8 @@ void MainWindow::autoPlayStep() {
             bool moved = moveTiles(nextDirection);
 
             if (moved) {
+                autoPlayer->startPonder(board);
+
                 // 如果新方向移动成功，生成新的数字块并继续游戏
                 if (pendingAnimations > 0) {
                     animationInProgress = true;
@@ -1399,18 +1479,23 @@ void MainWindow::autoPlayStep() {
 
 // findBestMove: 找出最佳移动方向
 int MainWindow::findBestMove() {
-    // 如果已经在计算中，返回上次计算的结果
     QMutexLocker locker(&aiMutex);
+
+    // 后台计算仍在进行时不能同时使用AI实例，返回-1由调用方处理
     if (aiCalculating) {
-        // 如果还没有计算结果，返回随机方向
-        if (aiCalculatedMove == -1) {
-            return QRandomGenerator::global()->bounded(4);
-        }
-        return aiCalculatedMove;
+        return -1;
     }
 
-    // 将当前棋盘状态传递给AI进行计算
-    int bestMove = autoPlayer->findBestMove(board);
+    // 后台已经为当前棋盘算出结果时直接使用，否则与自动操作一样在时间预算内同步计算，
+    // 预测搜索已经搜索过这个棋盘时 findBestMoveWithin 直接返回预测结果
+    int bestMove = -1;
+    if (aiCalculatedMove != -1 && aiBoard == board) {
+        bestMove         = aiCalculatedMove;
+        aiCalculatedMove = -1;
+    } else {
+        autoPlayer->clearStopRequest();
+        bestMove = autoPlayer->findBestMoveWithin(board, AI_TIME_BUDGET_MS);
+    }
 
     // 如果没有找到有效移动，尝试所有方向看哪个是有效的
     if (bestMove == -1) {
@@ -1440,19 +1525,22 @@ void MainWindow::startAiCalculation() {
     aiCalculating    = true;
     aiCalculatedMove = -1;
 
-    // 清除expectimax缓存，提高性能
-    autoPlayer->clearExpectimaxCache();
+    // 不清除AI缓存：上一步搜索过的子树大多仍可达，置换表会按世代淘汰旧表项
 
     // 复制当前棋盘状态供异步计算使用
     QVector<QVector<int>> boardCopy = board;
+    aiBoard                         = board;
+
+    // 在发起请求时清除上一次的停止请求，搜索线程开始前到达的超时或停止请求不会丢失
+    autoPlayer->clearStopRequest();
 
     // 启动超时定时器
     aiTimeoutTimer->start();
 
-    // 在单独线程中计算最佳移动
+    // 在单独线程中计算最佳移动，用完时间预算后返回最后完成的深度的结果
     aiFuture = QtConcurrent::run([this, boardCopy]() {
         // 计算最佳移动
-        int bestMove = autoPlayer->findBestMove(boardCopy);
+        int bestMove = autoPlayer->findBestMoveWithin(boardCopy, AI_TIME_BUDGET_MS);
 
         // 存储计算结果
         QMutexLocker locker(&aiMutex);
@@ -1483,18 +1571,11 @@ void MainWindow::onAiCalculationFinished() {
 void MainWindow::onAiCalculationTimeout() {
     QMutexLocker locker(&aiMutex);
 
-    // 如果计算仍然在进行，但超时了
+    // 搜索没有按时间预算返回（例如系统负载过高），要求它立即停止
+    // 搜索会带着最后完成的深度的结果返回，之后照常进入 onAiCalculationFinished
     if (aiCalculating) {
-        // 使用随机方向作为备选
-        aiCalculatedMove = QRandomGenerator::global()->bounded(4);
-
-        // 不等待计算完成，直接继续
-        aiCalculating = false;
-
-        // 如果自动操作仍然活跃，继续下一步
-        if (autoPlayActive && !animationInProgress) {
-            QTimer::singleShot(50, this, &MainWindow::autoPlayStep);
-        }
+        qDebug() << "AI calculation exceeded its time budget, stopping search";
+        autoPlayer->stopSearch();
     }
 }
 
@@ -1525,21 +1606,124 @@ void MainWindow::on_learnButton_clicked() {
     simulationsSpinBox->setValue(15);
     simulationsSpinBox->setToolTip("Number of game simulations to run for each parameter set");
 
+    QLabel* targetLabel     = new QLabel("Target Score:", settingsDialog);
+    QSpinBox* targetSpinBox = new QSpinBox(settingsDialog);
+    targetSpinBox->setRange(0, 1000000);
+    targetSpinBox->setSingleStep(1000);
+    targetSpinBox->setValue(0);
+    targetSpinBox->setSpecialValueText("Off");
+    targetSpinBox->setToolTip("Log how many parameter sets and games it took until one set averaged this score");
+
+    QLabel* islandsLabel     = new QLabel("Islands:", settingsDialog);
+    QSpinBox* islandsSpinBox = new QSpinBox(settingsDialog);
+    islandsSpinBox->setRange(1, 64);
+    islandsSpinBox->setValue(1);
+    islandsSpinBox->setToolTip("Split the population into independent subpopulations, one per CPU core");
+
+    QLabel* migrationLabel     = new QLabel("Migration Interval:", settingsDialog);
+    QSpinBox* migrationSpinBox = new QSpinBox(settingsDialog);
+    migrationSpinBox->setRange(1, 50);
+    migrationSpinBox->setValue(5);
+    migrationSpinBox->setToolTip("Generations between sending each island's best sets to the next island");
+
+    // 训练方法：遗传算法或 CMA-ES 调整启发式参数，或时间差分自我对弈训练N元组网络
+    QLabel* methodLabel       = new QLabel("Method:", settingsDialog);
+    QComboBox* methodComboBox = new QComboBox(settingsDialog);
+    methodComboBox->addItem("Genetic algorithm (heuristic parameters)");
+    methodComboBox->addItem("TD self-play (n-tuple network)");
+    methodComboBox->addItem("CMA-ES (heuristic parameters)");
+
+    QLabel* gamesLabel     = new QLabel("Self-play Games (thousands):", settingsDialog);
+    QSpinBox* gamesSpinBox = new QSpinBox(settingsDialog);
+    gamesSpinBox->setRange(1, 100000);
+    gamesSpinBox->setValue(100);
+    gamesSpinBox->setToolTip("Number of TD self-play games, shared by all CPU cores");
+
+    QLabel* learningRateLabel           = new QLabel("Learning Rate:", settingsDialog);
+    QDoubleSpinBox* learningRateSpinBox = new QDoubleSpinBox(settingsDialog);
+    learningRateSpinBox->setDecimals(3);
+    learningRateSpinBox->setRange(0.001, 1.0);
+    learningRateSpinBox->setSingleStep(0.01);
+    learningRateSpinBox->setValue(0.1);
+
+    QLabel* lambdaLabel           = new QLabel("Lambda:", settingsDialog);
+    QDoubleSpinBox* lambdaSpinBox = new QDoubleSpinBox(settingsDialog);
+    lambdaSpinBox->setDecimals(2);
+    lambdaSpinBox->setRange(0.0, 1.0);
+    lambdaSpinBox->setSingleStep(0.1);
+    lambdaSpinBox->setValue(0.5);
+    lambdaSpinBox->setToolTip("0 is TD(0); larger values propagate rewards further back in each game");
+
+    QCheckBox* pairedCheckBox = new QCheckBox("Same seeded games for every set in a generation", settingsDialog);
+    pairedCheckBox->setToolTip("Paired comparison cancels most spawn luck, so fewer simulations per set are needed");
+
+    QCheckBox* racingCheckBox = new QCheckBox("Stop simulating clearly weaker sets early", settingsDialog);
+    racingCheckBox->setToolTip("Successive halving: only the best sets play all simulations in each generation");
+
+    QCheckBox* multiFidelityCheckBox = new QCheckBox("Screen sets with cheap games before deep search", settingsDialog);
+    multiFidelityCheckBox->setToolTip("Greedy play for all sets, depth-2 search for the better half, full depth for "
+                                      "the finalists; rank correlations between the levels are logged");
+
+    QCheckBox* steadyStateCheckBox = new QCheckBox("Breed a new set whenever an evaluation finishes", settingsDialog);
+    steadyStateCheckBox->setToolTip("Steady-state genetic algorithm: keeps every core busy instead of waiting for "
+                                    "the slowest set of each generation; early stopping is not used");
+
     QCheckBox* saveParamsCheckBox = new QCheckBox("Save parameters after training", settingsDialog);
     saveParamsCheckBox->setChecked(true);
 
+    // 只启用所选方法的设置；训练时不会生效的组合直接禁用：岛模型和稳态算法不使用逐轮淘汰和多精度评估，
+    // 岛模型不按稳态方式进化，多精度评估优先于逐轮淘汰
+    auto updateMethodControls = [=]() {
+        int method  = methodComboBox->currentIndex();
+        bool td     = method == 1;
+        bool island = method == 0 && islandsSpinBox->value() > 1;
+        bool steady = method == 0 && !island && steadyStateCheckBox->isChecked();
+        for (QWidget* widget : {populationSpinBox, generationsSpinBox, simulationsSpinBox, targetSpinBox}) {
+            widget->setEnabled(!td);
+        }
+        for (QWidget* widget : {static_cast<QWidget*>(gamesSpinBox), learningRateSpinBox, lambdaSpinBox}) {
+            widget->setEnabled(td);
+        }
+        pairedCheckBox->setEnabled(!td);
+        multiFidelityCheckBox->setEnabled(!td && !island && !steady);
+        racingCheckBox->setEnabled(multiFidelityCheckBox->isEnabled() && !multiFidelityCheckBox->isChecked());
+        steadyStateCheckBox->setEnabled(method == 0 && !island);
+        islandsSpinBox->setEnabled(method == 0);
+        migrationSpinBox->setEnabled(island);
+        saveParamsCheckBox->setEnabled(!td);
+    };
+    updateMethodControls();
+    connect(methodComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), settingsDialog, updateMethodControls);
+    connect(islandsSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), settingsDialog, updateMethodControls);
+    connect(steadyStateCheckBox, &QCheckBox::toggled, settingsDialog, updateMethodControls);
+    connect(multiFidelityCheckBox, &QCheckBox::toggled, settingsDialog, updateMethodControls);
+
     // 创建按钮
     QPushButton* startButton  = new QPushButton("Start Training", settingsDialog);
     QPushButton* cancelButton = new QPushButton("Cancel", settingsDialog);
 
     // 布局
     QGridLayout* gridLayout = new QGridLayout();
-    gridLayout->addWidget(populationLabel, 0, 0);
-    gridLayout->addWidget(populationSpinBox, 0, 1);
-    gridLayout->addWidget(generationsLabel, 1, 0);
-    gridLayout->addWidget(generationsSpinBox, 1, 1);
-    gridLayout->addWidget(simulationsLabel, 2, 0);
-    gridLayout->addWidget(simulationsSpinBox, 2, 1);
+    gridLayout->addWidget(methodLabel, 0, 0);
+    gridLayout->addWidget(methodComboBox, 0, 1);
+    gridLayout->addWidget(populationLabel, 1, 0);
+    gridLayout->addWidget(populationSpinBox, 1, 1);
+    gridLayout->addWidget(generationsLabel, 2, 0);
+    gridLayout->addWidget(generationsSpinBox, 2, 1);
+    gridLayout->addWidget(simulationsLabel, 3, 0);
+    gridLayout->addWidget(simulationsSpinBox, 3, 1);
+    gridLayout->addWidget(targetLabel, 4, 0);
+    gridLayout->addWidget(targetSpinBox, 4, 1);
+    gridLayout->addWidget(islandsLabel, 5, 0);
+    gridLayout->addWidget(islandsSpinBox, 5, 1);
+    gridLayout->addWidget(migrationLabel, 6, 0);
+    gridLayout->addWidget(migrationSpinBox, 6, 1);
+    gridLayout->addWidget(gamesLabel, 7, 0);
+    gridLayout->addWidget(gamesSpinBox, 7, 1);
+    gridLayout->addWidget(learningRateLabel, 8, 0);
+    gridLayout->addWidget(learningRateSpinBox, 8, 1);
+    gridLayout->addWidget(lambdaLabel, 9, 0);
+    gridLayout->addWidget(lambdaSpinBox, 9, 1);
 
     QHBoxLayout* buttonLayout = new QHBoxLayout();
     buttonLayout->addWidget(cancelButton);
@@ -1547,6 +1731,10 @@ void MainWindow::on_learnButton_clicked() {
 
     QVBoxLayout* mainLayout = new QVBoxLayout(settingsDialog);
     mainLayout->addLayout(gridLayout);
+    mainLayout->addWidget(pairedCheckBox);
+    mainLayout->addWidget(racingCheckBox);
+    mainLayout->addWidget(multiFidelityCheckBox);
+    mainLayout->addWidget(steadyStateCheckBox);
     mainLayout->addWidget(saveParamsCheckBox);
     mainLayout->addLayout(buttonLayout);
 
@@ -1564,7 +1752,23 @@ void MainWindow::on_learnButton_clicked() {
     int populationSize = populationSpinBox->value();
     int generations    = generationsSpinBox->value();
     int simulations    = simulationsSpinBox->value();
-    bool saveParams    = saveParamsCheckBox->isChecked();
+    bool tdTraining    = methodComboBox->currentIndex() == 1;
+    quint64 tdGames    = static_cast<quint64>(gamesSpinBox->value()) * 1000;
+    double learnRate   = learningRateSpinBox->value();
+    double lambda      = lambdaSpinBox->value();
+    bool saveParams    = saveParamsCheckBox->isChecked() && !tdTraining;
+
+    ParameterTrainingOptions trainingOptions;
+    trainingOptions.commonRandomNumbers = pairedCheckBox->isChecked();
+    trainingOptions.racing              = racingCheckBox->isEnabled() && racingCheckBox->isChecked();
+    trainingOptions.multiFidelity       = multiFidelityCheckBox->isEnabled() && multiFidelityCheckBox->isChecked();
+    trainingOptions.steadyState         = steadyStateCheckBox->isEnabled() && steadyStateCheckBox->isChecked();
+    trainingOptions.islands             = islandsSpinBox->value();
+    trainingOptions.migrationInterval   = migrationSpinBox->value();
+    trainingOptions.targetScore         = targetSpinBox->value();
+    if (methodComboBox->currentIndex() == 2) {
+        trainingOptions.optimizer = ParameterTrainingOptions::Optimizer::CmaEs;
+    }
 
     settingsDialog->deleteLater();
 
@@ -1585,11 +1789,21 @@ void MainWindow::on_learnButton_clicked() {
     QLabel* bestScoreLabel  = new QLabel("Best Score: 0", trainingDialog);
 
     // 创建参数显示区域
-    QGroupBox* paramsGroupBox = new QGroupBox("Current Best Parameters", trainingDialog);
+    // 时间差分训练没有参数向量，这里显示训练速度等统计
+    QGroupBox* paramsGroupBox =
+        new QGroupBox(tdTraining ? "Training Statistics" : "Current Best Parameters", trainingDialog);
     QGridLayout* paramsLayout = new QGridLayout(paramsGroupBox);
+    QStringList paramNames;
+    if (tdTraining) {
+        paramNames = {"Games per second:", "Average score:", "Max tile:"};
+    } else {
+        for (int i = 0; i < 5; i++) {
+            paramNames.append(QString("Parameter %1:").arg(i + 1));
+        }
+    }
     QVector<QLabel*> paramLabels;
-    for (int i = 0; i < 5; i++) {
-        QLabel* nameLabel  = new QLabel(QString("Parameter %1:").arg(i + 1));
+    for (int i = 0; i < paramNames.size(); i++) {
+        QLabel* nameLabel  = new QLabel(paramNames[i]);
         QLabel* valueLabel = new QLabel("0.00");
         paramLabels.append(valueLabel);
         paramsLayout->addWidget(nameLabel, i, 0);
@@ -1658,6 +1872,24 @@ void MainWindow::on_learnButton_clicked() {
     connect(trainingProgress,
             &TrainingProgress::progressUpdated,
             [=](int generation, int totalGenerations, int bestScore, QVector<double> const& bestParams) {
+                // 时间差分训练每次报告附带 {每秒局数, 平均分, 最大方块}
+                if (tdTraining) {
+                    statusLabel->setText("Training n-tuple network by TD self-play...");
+                    generationLabel->setText(QString("Report: %1").arg(generation));
+                    bestScoreLabel->setText(QString("Average Score: %1").arg(bestScore));
+                    for (int i = 0; i < bestParams.size() && i < paramLabels.size(); i++) {
+                        paramLabels[i]->setText(QString::number(bestParams[i], 'f', 0));
+                    }
+                    if (bestParams.size() >= 3) {
+                        resultsDisplay->append(QString("Report %1: Avg Score = %2, %3 games/s, Max Tile = %4")
+                                                   .arg(generation)
+                                                   .arg(bestScore)
+                                                   .arg(bestParams[0], 0, 'f', 0)
+                                                   .arg(bestParams[2], 0, 'f', 0));
+                    }
+                    return;
+                }
+
                 // 更新标签
                 statusLabel->setText(QString("Training generation %1 of %2...").arg(generation).arg(totalGenerations));
                 generationLabel->setText(QString("Generation: %1/%2").arg(generation).arg(totalGenerations));
@@ -1676,8 +1908,15 @@ void MainWindow::on_learnButton_clicked() {
         trainingProgress,
         &TrainingProgress::trainingCompleted,
         this,
-        [this, statusLabel, progressBar, resultsDisplay, stopButton, learnButton, saveParams, trainingDialog](
-            int finalScore, QVector<double> const& finalParams) {
+        [this,
+         statusLabel,
+         progressBar,
+         resultsDisplay,
+         stopButton,
+         learnButton,
+         saveParams,
+         tdTraining,
+         trainingDialog](int finalScore, QVector<double> const& finalParams) {
             // 使用QMetaObject::invokeMethod确保在主线程中更新UI
             QMetaObject::invokeMethod(
                 this,
@@ -1688,6 +1927,7 @@ void MainWindow::on_learnButton_clicked() {
                  stopButton,
                  learnButton,
                  saveParams,
+                 tdTraining,
                  finalScore,
                  finalParams,
                  trainingDialog]() {
@@ -1697,10 +1937,16 @@ void MainWindow::on_learnButton_clicked() {
 
                     // 显示最终结果
                     resultsDisplay->append("\nTraining completed!");
-                    resultsDisplay->append(QString("Final Best Score: %1").arg(finalScore));
-                    resultsDisplay->append("\nFinal Parameters:");
-                    for (int i = 0; i < finalParams.size(); i++) {
-                        resultsDisplay->append(QString("Parameter %1: %2").arg(i + 1).arg(finalParams[i], 0, 'f', 2));
+                    if (tdTraining) {
+                        resultsDisplay->append(QString("Final Average Score: %1").arg(finalScore));
+                        resultsDisplay->append("N-tuple weights saved to the data directory.");
+                    } else {
+                        resultsDisplay->append(QString("Final Best Score: %1").arg(finalScore));
+                        resultsDisplay->append("\nFinal Parameters:");
+                        for (int i = 0; i < finalParams.size(); i++) {
+                            resultsDisplay->append(
+                                QString("Parameter %1: %2").arg(i + 1).arg(finalParams[i], 0, 'f', 2));
+                        }
                     }
 
                     // 保存参数
@@ -1792,7 +2038,17 @@ void MainWindow::on_learnButton_clicked() {
     connect(trainingThread,
             &QThread::started,
             worker,
-            [this, uiUpdateTimer, trainingThread, populationSize, generations, simulations]() {
+            [this,
+             uiUpdateTimer,
+             trainingThread,
+             populationSize,
+             generations,
+             simulations,
+             tdTraining,
+             tdGames,
+             learnRate,
+             lambda,
+             trainingOptions]() {
                 qDebug() << "Training thread started";
 
                 try {
@@ -1803,7 +2059,11 @@ void MainWindow::on_learnButton_clicked() {
                     }
 
                     // 调用Auto类的学习方法
-                    autoPlayer->learnParameters(populationSize, generations, simulations);
+                    if (tdTraining) {
+                        autoPlayer->learnNTupleNetwork(tdGames, learnRate, lambda);
+                    } else {
+                        autoPlayer->learnParameters(populationSize, generations, simulations, trainingOptions);
+                    }
                     qDebug() << "Training function completed successfully";
                 } catch (std::exception const& e) {
                     qDebug() << "Exception in training thread:" << e.what();
@@ -63,11 +63,12 @@ class MainWindow : public QMainWindow {
     Auto* autoPlayer;       // 自动操作类实例
 
     // AI线程相关
-    QFuture<int> aiFuture;   // 用于异步计算最佳移动
-    bool aiCalculating;      // 标记AI是否正在计算
-    QMutex aiMutex;          // 用于保护AI计算状态
-    int aiCalculatedMove;    // 存储计算出的最佳移动
-    QTimer* aiTimeoutTimer;  // 超时定时器，防止AI计算时间过长
+    QFuture<int> aiFuture;          // 用于异步计算最佳移动
+    bool aiCalculating;             // 标记AI是否正在计算
+    QMutex aiMutex;                 // 用于保护AI计算状态
+    int aiCalculatedMove;           // 存储计算出的最佳移动
+    QVector<QVector<int>> aiBoard;  // aiCalculatedMove 对应的棋盘
+    QTimer* aiTimeoutTimer;         // 超时定时器，搜索未按预算返回时要求其停止
 
     // 初始化函数
     void setupBoard();
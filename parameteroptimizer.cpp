@@ -0,0 +1,328 @@
+#include "parameteroptimizer.h"
+
+#include "auto.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+// 参数的取值范围，与 Auto::mutate 的截断相同
+static double const kMinParam = 0.0;
+static double const kMaxParam = 20.0;
+
+// 步长的上限，为参数范围的一半，避免分数相同时步长无限增长
+static double const kMaxStepSize = 10.0;
+
+static double clampParam(double value) {
+    return std::max(kMinParam, std::min(value, kMaxParam));
+}
+
+QVector<QVector<double>> initialGeneticPopulation(int populationSize,
+                                                  QVector<double> const& start,
+                                                  bool seedWithStart,
+                                                  engine2048::FastRandom& random) {
+    QVector<QVector<double>> population;
+
+    // 初始化种群中的每个个体
+    for (int i = 0; i < populationSize; ++i) {
+        if (i == 0 && seedWithStart) {
+            // 将当前最佳参数加入种群
+            population.append(start);
+        } else if (i == 1 && seedWithStart) {
+            // 将当前最佳参数的微小变异加入种群
+            QVector<double> slightlyModified = start;
+            for (int j = 0; j < slightlyModified.size(); ++j) {
+                // 在原有参数基础上增加小的随机变化
+                slightlyModified[j] *= (1.0 + random.uniform(-0.05, 0.05));  // 正负5%的变化
+                slightlyModified[j]  = clampParam(slightlyModified[j]);
+            }
+            population.append(slightlyModified);
+        } else {
+            // 生成随机参数
+            QVector<double> params(5);
+            for (int j = 0; j < 5; ++j) {
+                params[j] = random.uniform(0.0, 10.0);  // 生成 0-10 之间的随机浮点数
+            }
+            population.append(params);
+        }
+    }
+    return population;
+}
+
+GeneticOptimizer::GeneticOptimizer(Auto* autoPlayer,
+                                   int populationSize,
+                                   QVector<double> const& start,
+                                   bool seedWithStart,
+                                   engine2048::FastRandom& random)
+    : autoPlayer(autoPlayer),
+      populationSize(populationSize),
+      population(initialGeneticPopulation(populationSize, start, seedWithStart, random)) {}
+
+QVector<QVector<double>> GeneticOptimizer::ask(engine2048::FastRandom&) {
+    return population;
+}
+
+void GeneticOptimizer::tell(QVector<QVector<double>> const& candidates,
+                            QVector<int> const& scores,
+                            engine2048::FastRandom& random) {
+    // 创建新一代
+    QVector<QVector<double>> newPopulation;
+
+    // 精英选择 - 保留最佳的五个个体
+    QVector<int> indices = autoPlayer->findTopIndices(scores, 5);
+    for (int idx : indices) {
+        newPopulation.append(candidates[idx]);
+    }
+
+    // 交叉和变异生成新一代
+    while (newPopulation.size() < populationSize) {
+        try {
+            // 选择两个父代进行交叉
+            int parent1 = autoPlayer->tournamentSelection(scores, random);
+            int parent2 = autoPlayer->tournamentSelection(scores, random);
+
+            // 确保索引有效
+            if (parent1 < 0 || parent1 >= candidates.size() || parent2 < 0 || parent2 >= candidates.size()) {
+                qDebug() << "Invalid parent index:" << parent1 << parent2;
+                continue;
+            }
+
+            // 交叉
+            QVector<double> child = autoPlayer->crossover(candidates[parent1], candidates[parent2], random);
+
+            // 变异 - 增加变异率以提高多样性
+            autoPlayer->mutate(child, random, 0.3);  // 增加变异率到 30%
+
+            // 添加到新种群
+            newPopulation.append(child);
+        } catch (std::exception const& e) {
+            qDebug() << "Exception in crossover/mutation:" << e.what();
+            // 出错时创建一个随机个体
+            QVector<double> randomParams(5);
+            for (int j = 0; j < 5; ++j) {
+                randomParams[j] = random.uniform(0.0, 10.0);  // 生成新的随机参数
+            }
+            newPopulation.append(randomParams);
+        }
+    }
+
+    // 替换旧种群
+    population = newPopulation;
+}
+
+QVector<double> SteadyStatePopulation::breed(engine2048::FastRandom& random) {
+    int parent1 = autoPlayer->tournamentSelection(scores, random);
+    int parent2 = autoPlayer->tournamentSelection(scores, random);
+
+    QVector<double> child = autoPlayer->crossover(members[parent1], members[parent2], random);
+    autoPlayer->mutate(child, random, 0.3);
+    return child;
+}
+
+void SteadyStatePopulation::insert(QVector<double> const& params, int score) {
+    if (members.size() < capacity) {
+        members.append(params);
+        scores.append(score);
+        return;
+    }
+
+    int worst = static_cast<int>(std::min_element(scores.begin(), scores.end()) - scores.begin());
+    if (score > scores[worst]) {
+        members[worst] = params;
+        scores[worst]  = score;
+    }
+}
+
+CmaEsOptimizer::CmaEsOptimizer(int populationSize, QVector<double> const& start, double initialStepSize)
+    : dimension(start.size()),
+      lambda(std::max(populationSize, 4 + static_cast<int>(3 * std::log(start.size())))),
+      mu(lambda / 2),
+      mean(start),
+      stepSize(initialStepSize),
+      pathC(start.size(), 0.0),
+      pathSigma(start.size(), 0.0),
+      scales(start.size(), 1.0) {
+    // 对数递减的重组权重
+    double weightSum       = 0.0;
+    double weightSquareSum = 0.0;
+    for (int i = 0; i < mu; ++i) {
+        weights.append(std::log((lambda + 1) / 2.0) - std::log(i + 1.0));
+        weightSum += weights[i];
+    }
+    for (double& weight : weights) {
+        weight          /= weightSum;
+        weightSquareSum += weight * weight;
+    }
+    muEffective = 1.0 / weightSquareSum;
+
+    double n        = dimension;
+    cumulationC     = (4 + muEffective / n) / (n + 4 + 2 * muEffective / n);
+    cumulationSigma = (muEffective + 2) / (n + muEffective + 5);
+    rankOne         = 2 / ((n + 1.3) * (n + 1.3) + muEffective);
+    rankMu          = 2 * (muEffective - 2 + 1 / muEffective) / ((n + 2) * (n + 2) + muEffective);
+    rankMu          = std::min(1 - rankOne, rankMu);
+    damping         = 1 + 2 * std::max(0.0, std::sqrt((muEffective - 1) / (n + 1)) - 1) + cumulationSigma;
+    expectedNorm    = std::sqrt(n) * (1 - 1 / (4 * n) + 1 / (21 * n * n));
+
+    // 初始协方差为单位矩阵
+    covariance = QVector<QVector<double>>(dimension, QVector<double>(dimension, 0.0));
+    basis      = covariance;
+    for (int i = 0; i < dimension; ++i) {
+        covariance[i][i] = 1.0;
+        basis[i][i]      = 1.0;
+    }
+}
+
+QVector<QVector<double>> CmaEsOptimizer::ask(engine2048::FastRandom& random) {
+    // x = mean + σ·B·D·z，z ~ N(0, I)
+    QVector<QVector<double>> candidates;
+    for (int k = 0; k < lambda; ++k) {
+        QVector<double> z(dimension);
+        for (double& value : z) {
+            value = random.normal();
+        }
+        QVector<double> x(dimension);
+        for (int i = 0; i < dimension; ++i) {
+            double offset = 0.0;
+            for (int j = 0; j < dimension; ++j) {
+                offset += basis[i][j] * scales[j] * z[j];
+            }
+            x[i] = clampParam(mean[i] + stepSize * offset);
+        }
+        candidates.append(x);
+    }
+    return candidates;
+}
+
+void CmaEsOptimizer::tell(QVector<QVector<double>> const& candidates,
+                          QVector<int> const& scores,
+                          engine2048::FastRandom&) {
+    QVector<int> order(candidates.size());
+    for (int i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&scores](int a, int b) { return scores[a] > scores[b]; });
+
+    // 前 mu 个样本相对旧均值的步长 y_i = (x_i - mean) / σ，以及加权和 y_w
+    int selected = std::min(mu, static_cast<int>(order.size()));
+    QVector<QVector<double>> steps;
+    QVector<double> weightedStep(dimension, 0.0);
+    for (int k = 0; k < selected; ++k) {
+        QVector<double> step(dimension);
+        for (int i = 0; i < dimension; ++i) {
+            step[i]          = (candidates[order[k]][i] - mean[i]) / stepSize;
+            weightedStep[i] += weights[k] * step[i];
+        }
+        steps.append(step);
+    }
+    for (int i = 0; i < dimension; ++i) {
+        mean[i] += stepSize * weightedStep[i];
+    }
+
+    // C^(-1/2)·y_w = B·D^(-1)·Bᵀ·y_w
+    QVector<double> rotated(dimension, 0.0);
+    for (int j = 0; j < dimension; ++j) {
+        double projection = 0.0;
+        for (int i = 0; i < dimension; ++i) {
+            projection += basis[i][j] * weightedStep[i];
+        }
+        for (int i = 0; i < dimension; ++i) {
+            rotated[i] += basis[i][j] * projection / scales[j];
+        }
+    }
+
+    // 步长的进化路径
+    double sigmaFactor = std::sqrt(cumulationSigma * (2 - cumulationSigma) * muEffective);
+    double pathNorm    = 0.0;
+    for (int i = 0; i < dimension; ++i) {
+        pathSigma[i]  = (1 - cumulationSigma) * pathSigma[i] + sigmaFactor * rotated[i];
+        pathNorm     += pathSigma[i] * pathSigma[i];
+    }
+    pathNorm = std::sqrt(pathNorm);
+
+    // 步长路径过长时暂停协方差路径的累积，避免步长快速增大时 C 被拉得过长
+    ++generation;
+    double normalizer = std::sqrt(1 - std::pow(1 - cumulationSigma, 2.0 * generation));
+    bool stalled      = pathNorm / normalizer >= (1.4 + 2 / (dimension + 1.0)) * expectedNorm;
+    double covFactor  = std::sqrt(cumulationC * (2 - cumulationC) * muEffective);
+    for (int i = 0; i < dimension; ++i) {
+        pathC[i] = (1 - cumulationC) * pathC[i] + (stalled ? 0.0 : covFactor * weightedStep[i]);
+    }
+
+    // 秩1更新加秩μ更新
+    double decay = 1 - rankOne - rankMu + (stalled ? rankOne * cumulationC * (2 - cumulationC) : 0.0);
+    for (int i = 0; i < dimension; ++i) {
+        for (int j = 0; j <= i; ++j) {
+            double rankMuTerm = 0.0;
+            for (int k = 0; k < selected; ++k) {
+                rankMuTerm += weights[k] * steps[k][i] * steps[k][j];
+            }
+            double value     = decay * covariance[i][j] + rankOne * pathC[i] * pathC[j] + rankMu * rankMuTerm;
+            covariance[i][j] = value;
+            covariance[j][i] = value;
+        }
+    }
+
+    stepSize *= std::exp((cumulationSigma / damping) * (pathNorm / expectedNorm - 1));
+    stepSize  = std::min(stepSize, kMaxStepSize);
+
+    decompose();
+}
+
+void CmaEsOptimizer::decompose() {
+    // 循环 Jacobi 旋转，把对称矩阵逐步对角化，5×5 的矩阵几轮就收敛
+    QVector<QVector<double>> matrix = covariance;
+    for (int i = 0; i < dimension; ++i) {
+        for (int j = 0; j < dimension; ++j) {
+            basis[i][j] = i == j ? 1.0 : 0.0;
+        }
+    }
+
+    for (int sweep = 0; sweep < 50; ++sweep) {
+        double offDiagonal = 0.0;
+        for (int p = 0; p < dimension; ++p) {
+            for (int q = p + 1; q < dimension; ++q) {
+                offDiagonal += matrix[p][q] * matrix[p][q];
+            }
+        }
+        if (offDiagonal < 1e-20) {
+            break;
+        }
+
+        for (int p = 0; p < dimension; ++p) {
+            for (int q = p + 1; q < dimension; ++q) {
+                if (std::abs(matrix[p][q]) < 1e-30) {
+                    continue;
+                }
+                // 选择旋转角使 matrix[p][q] 变为0
+                double theta   = (matrix[q][q] - matrix[p][p]) / (2 * matrix[p][q]);
+                double tangent = (theta >= 0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1));
+                double cosine  = 1 / std::sqrt(tangent * tangent + 1);
+                double sine    = tangent * cosine;
+                for (int k = 0; k < dimension; ++k) {
+                    double kp    = matrix[k][p];
+                    double kq    = matrix[k][q];
+                    matrix[k][p] = cosine * kp - sine * kq;
+                    matrix[k][q] = sine * kp + cosine * kq;
+                }
+                for (int k = 0; k < dimension; ++k) {
+                    double pk    = matrix[p][k];
+                    double qk    = matrix[q][k];
+                    matrix[p][k] = cosine * pk - sine * qk;
+                    matrix[q][k] = sine * pk + cosine * qk;
+                }
+                for (int k = 0; k < dimension; ++k) {
+                    double kp   = basis[k][p];
+                    double kq   = basis[k][q];
+                    basis[k][p] = cosine * kp - sine * kq;
+                    basis[k][q] = sine * kp + cosine * kq;
+                }
+            }
+        }
+    }
+
+    // 数值误差可能让很小的特征值变成负数，设一个下限
+    for (int i = 0; i < dimension; ++i) {
+        scales[i] = std::sqrt(std::max(matrix[i][i], 1e-20));
+    }
+}
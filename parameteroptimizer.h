@@ -0,0 +1,126 @@
+#ifndef PARAMETEROPTIMIZER_H
+#define PARAMETEROPTIMIZER_H
+
+#include <QVector>
+
+class Auto;
+
+namespace engine2048 {
+class FastRandom;
+}
+
+// 启发式参数的优化算法，按 ask/tell 交替进行
+//
+// ask 给出一代要评估的参数组，调用方评估后把每组的平均分按同样的顺序交给 tell，
+// 算法据此产生下一代。评估方式（对局数、共用随机数、逐轮淘汰）由调用方决定，与算法无关。
+class ParameterOptimizer {
+   public:
+    virtual ~ParameterOptimizer() = default;
+
+    // 用于日志和保存结果的名字
+    virtual char const* name() const = 0;
+
+    virtual QVector<QVector<double>> ask(engine2048::FastRandom& random) = 0;
+
+    virtual void tell(QVector<QVector<double>> const& candidates,
+                      QVector<int> const& scores,
+                      engine2048::FastRandom& random) = 0;
+};
+
+// 遗传算法的初始种群：seedWithStart 为 true 时前两个个体为 start 和它的一个微小变异，其余随机生成
+QVector<QVector<double>> initialGeneticPopulation(int populationSize,
+                                                  QVector<double> const& start,
+                                                  bool seedWithStart,
+                                                  engine2048::FastRandom& random);
+
+// 遗传算法：保留最好的5个个体，其余由锦标赛选择、均匀交叉和变异产生
+class GeneticOptimizer : public ParameterOptimizer {
+   public:
+    // seedWithStart 为 true 时把 start 和它的一个微小变异放进初始种群，其余个体随机生成
+    GeneticOptimizer(Auto* autoPlayer,
+                     int populationSize,
+                     QVector<double> const& start,
+                     bool seedWithStart,
+                     engine2048::FastRandom& random);
+
+    char const* name() const override { return "genetic"; }
+
+    QVector<QVector<double>> ask(engine2048::FastRandom& random) override;
+
+    void tell(QVector<QVector<double>> const& candidates,
+              QVector<int> const& scores,
+              engine2048::FastRandom& random) override;
+
+   private:
+    Auto* autoPlayer;
+    int populationSize;
+    QVector<QVector<double>> population;
+};
+
+// 稳态遗传算法的种群，没有代的划分
+//
+// 每评估完一个个体就插入种群；种群满后新个体只替换分数最低的个体，而且要比它好。
+// 随时可以从当前种群繁殖一个新个体，选择、交叉和变异与 GeneticOptimizer 相同。
+// 只在训练线程上使用，不是线程安全的。
+class SteadyStatePopulation {
+   public:
+    SteadyStatePopulation(Auto* autoPlayer, int capacity) : autoPlayer(autoPlayer), capacity(capacity) {}
+
+    bool isEmpty() const { return members.isEmpty(); }
+
+    QVector<double> breed(engine2048::FastRandom& random);
+
+    void insert(QVector<double> const& params, int score);
+
+   private:
+    Auto* autoPlayer;
+    int capacity;
+    QVector<QVector<double>> members;
+    QVector<int> scores;
+};
+
+// CMA-ES（协方差矩阵自适应进化策略），(μ/μ_w, λ) 加权重组
+//
+// 每代从 N(mean, σ²C) 采样 λ 组参数，按分数排序后取前一半加权更新均值，用进化路径和
+// 前一半的样本更新协方差矩阵 C 和步长 σ。参数只有5个，每代对 C 做一次 Jacobi 特征分解即可。
+// 采样点截断到 [0, 20] 后再评估，更新时使用截断后的点。各常数取 Hansen 教程中的默认值。
+class CmaEsOptimizer : public ParameterOptimizer {
+   public:
+    CmaEsOptimizer(int populationSize, QVector<double> const& start, double initialStepSize);
+
+    char const* name() const override { return "cma-es"; }
+
+    QVector<QVector<double>> ask(engine2048::FastRandom& random) override;
+
+    void tell(QVector<QVector<double>> const& candidates,
+              QVector<int> const& scores,
+              engine2048::FastRandom& random) override;
+
+   private:
+    // 对 covariance 做特征分解，更新 basis（列为特征向量）和 scales（特征值的平方根）
+    void decompose();
+
+    int dimension;
+    int lambda;
+    int mu;
+    QVector<double> weights;  // 前 mu 个样本的重组权重，和为1
+    double muEffective;
+
+    double cumulationC;      // c_c
+    double cumulationSigma;  // c_σ
+    double rankOne;          // c_1
+    double rankMu;           // c_μ
+    double damping;          // d_σ
+    double expectedNorm;     // E||N(0, I)||
+
+    QVector<double> mean;
+    double stepSize;
+    QVector<double> pathC;
+    QVector<double> pathSigma;
+    QVector<QVector<double>> covariance;
+    QVector<QVector<double>> basis;
+    QVector<double> scales;
+    int generation = 0;
+};
+
+#endif  // PARAMETEROPTIMIZER_H
@@ -1,215 +1,231 @@
 #include "trainingworker.h"
 
 #include "auto.h"
+#include "parameteroptimizer.h"
+#include "self_play.h"
+#include "td_trainer.h"
 
 #include <QApplication>
 #include <QDateTime>
 #include <QDebug>
 #include <QDir>
+#include <QFileInfo>
 #include <QMessageBox>
 #include <QMutexLocker>
 #include <QThreadPool>
-#include <random>
+#include <QWaitCondition>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// 同一进程中的第 n 次训练使用 FastRandom(randomSeed(), n)，固定进程种子即可复现每一次训练
+static engine2048::FastRandom trainingRandom() {
+    static std::atomic<uint64_t> trainingRuns{0};
+    return engine2048::FastRandom(engine2048::randomSeed(), trainingRuns.fetch_add(1, std::memory_order_relaxed));
+}
 
-void TrainingWorker::doTraining() {
-    // 初始化随机数生成器
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> dis(0.0, 10.0);
+// 逐轮淘汰时最后留下的个体数，与精英选择保留的个数相同
+static int const kRaceFinalists = 5;
 
-    // 初始化种群
-    QVector<QVector<double>> population;
-    QVector<double> bestParams;
-    int bestScore = 0;
+// 第一轮每个个体的对局数占 simulations 的比例，之后每轮翻倍
+static int const kRaceInitialFraction = 8;
 
-    // 使用当前的最佳参数作为起点
-    if (autoPlayer->useLearnedParams && !autoPlayer->strategyParams.isEmpty()) {
-        bestParams = autoPlayer->strategyParams;
-        bestScore  = autoPlayer->bestHistoricalScore;
-        qDebug() << "Starting training with existing parameters. Historical best score:" << bestScore;
-    } else {
-        bestParams = QVector<double>(5, 1.0);
-        qDebug() << "Starting training with default parameters.";
-    }
+// 多精度评估每一层的搜索深度（Auto::expectimax 的约定）：一步贪心、走子-新方块-走子、Auto::findBestMove 的深度
+static int const kFidelityLevels                  = 3;
+static int const kFidelityDepths[kFidelityLevels] = {0, 2, 3};
 
-    // 初始化种群中的每个个体
-    for (int i = 0; i < populationSize; ++i) {
-        if (i == 0 && autoPlayer->useLearnedParams) {
-            // 将当前最佳参数加入种群
-            population.append(bestParams);
-        } else if (i == 1 && autoPlayer->useLearnedParams) {
-            // 将当前最佳参数的微小变异加入种群
-            QVector<double> slightlyModified = bestParams;
-            for (int j = 0; j < slightlyModified.size(); ++j) {
-                // 在原有参数基础上增加小的随机变化
-                slightlyModified[j] *= (1.0 + (dis(gen) * 0.1 - 0.05));  // 正负5%的变化
-                slightlyModified[j]  = std::max(0.0, std::min(slightlyModified[j], 20.0));
-            }
-            population.append(slightlyModified);
-        } else {
-            // 生成随机参数
-            QVector<double> params(5);
-            for (int j = 0; j < 5; ++j) {
-                params[j] = dis(gen);  // 生成 0-10 之间的随机浮点数
-            }
-            population.append(params);
-        }
-    }
+// 报告相关系数的精度对：相邻两层，以及最低和最高层
+static int const kFidelityPairs[3][2] = {{0, 1}, {1, 2}, {0, 2}};
 
-    // 进化多代
-    for (int gen = 0; gen < generations && autoPlayer->trainingActive.load(); ++gen) {
-        QVector<int> scores(populationSize, 0);
-        QVector<bool> evaluated(populationSize, false);
-        int evaluatedCount = 0;
-
-        // 并行评估每个个体
-        for (int i = 0; i < populationSize; ++i) {
-            // 复制当前索引和其他必要的值，避免捕获引用
-            int currentIndex = i;
-            int currentGen   = gen;
-
-            auto* task = new TrainingTask(
-                population[i],
-                simulations,
-                // 最终回调 - 使用共享指针来安全地更新数据
-                [this,
-                 currentIndex,
-                 &scores,
-                 &evaluated,
-                 &evaluatedCount,
-                 &bestScore,
-                 &bestParams,
-                 currentGen,
-                 &population](int score) {
-                    // 更新分数
-                    scores[currentIndex]    = score;
-                    evaluated[currentIndex] = true;
-                    evaluatedCount++;
-
-                    // 更新最佳参数
-                    if (score > bestScore) {
-                        QMutexLocker locker(&autoPlayer->mutex);
-                        bestScore  = score;
-                        bestParams = population[currentIndex];
-                    }
-
-                    // 当所有个体都已评估完成时，发送进度更新
-                    QMutexLocker locker(&autoPlayer->mutex);
-                    if (evaluatedCount == population.size()) {
-                        // 发送进度更新信号
-                        emit autoPlayer->trainingProgress.progressUpdated(
-                            currentGen + 1, generations, bestScore, bestParams);
-                    }
-                },
-                // 进度回调 - 使用当前的最佳分数和参数，而不是引用外部变量
-                [this, currentIndex, currentGen](int current, int total, int avgScore) {
-                    // 使用互斥锁保护的情况下获取当前的最佳分数和参数
-                    {
-                        QMutexLocker locker(&autoPlayer->mutex);
-                        // 这里可以访问共享数据如果需要
-                    }
-
-                    // 计算总体进度 - 使用更稳定的进度计算
-                    int totalProgress = 0;
-                    {
-                        QMutexLocker locker(&autoPlayer->mutex);
-                        // 每个个体的模拟进度占总进度的一小部分
-                        double genProgress = static_cast<double>(currentGen) / this->generations;
-                        double indProgress = static_cast<double>(currentIndex) / this->populationSize;
-                        double simProgress = static_cast<double>(current) / total;
-
-                        // 每一代占总进度的比例
-                        double genWeight = 1.0 / this->generations;
-
-                        // 计算总进度
-                        totalProgress = static_cast<int>(
-                            (genProgress + (indProgress + simProgress * 0.8) * genWeight / this->populationSize) * 100);
-                        totalProgress = qMin(totalProgress, 99);  // 确保不会显示100%直到真正完成
-                    }
-
-                    // 发送模拟进度更新
-                    emit autoPlayer->trainingProgress.simulationUpdated(current, total, avgScore, totalProgress);
-                });
+// 岛屿模型中每个岛的最小种群，要比精英选择保留的5个多
+static int const kMinIslandPopulation = 8;
 
-            // 设置任务为自动删除
-            task->setAutoDelete(true);
+// 岛屿模型每次迁出的个体数
+static int const kMigrants = 2;
 
-            // 提交任务到线程池
-            QThreadPool::globalInstance()->start(task);
-        }
+// 在当前线程的自我对弈上下文中用 params 下 games 局，对局只由 seed 决定，每局结束时用分数调用 onGameFinished
+// searchDepth 为 -1 时用训练的自我对弈走子，否则按 engine2048::playSearchGames 搜索 searchDepth 层
+// 参数不足5个时其余取1.0
+static void simulateOnThread(QVector<double> const& params,
+                             int games,
+                             quint64 seed,
+                             int searchDepth,
+                             std::function<void(int score)> const& onGameFinished) {
+    engine2048::HeuristicParams heuristicParams;
+    for (int i = 0; i < static_cast<int>(heuristicParams.size()); ++i) {
+        heuristicParams[i] = i < params.size() ? params[i] : 1.0;
+    }
+    engine2048::ParamEvaluator const& evaluator =
+        engine2048::SelfPlayContext::forThread().evaluatorFor(heuristicParams);
+    auto onFinished = [&onGameFinished](size_t, engine2048::GameResult const& result) {
+        onGameFinished(result.score);
+    };
+    size_t count = static_cast<size_t>(std::max(games, 0));
+    if (searchDepth < 0) {
+        engine2048::playSelfPlayGames(evaluator, count, seed, onFinished);
+    } else {
+        engine2048::playSearchGames(evaluator, count, seed, searchDepth, onFinished);
+    }
+}
 
-        // 等待所有任务完成
-        QThreadPool::globalInstance()->waitForDone();
+// 在线程池线程上执行一个函数
+class FunctionTask : public QRunnable {
+   public:
+    explicit FunctionTask(std::function<void()> function) : function(std::move(function)) {}
 
-        // 如果训练已停止，则退出
-        if (!autoPlayer->trainingActive.load()) {
-            break;
-        }
+    void run() override { function(); }
 
-        // 找出本代最佳分数
-        int genBestScore = 0;
+   private:
+    std::function<void()> function;
+};
 
-        for (int i = 0; i < populationSize; ++i) {
-            genBestScore = std::max(genBestScore, scores[i]);
-
-            // 更新全局最佳参数
-            if (scores[i] > bestScore) {
-                bestScore  = scores[i];
-                bestParams = population[i];
+// 两组分数的 Spearman 等级相关系数，相同的分数取平均名次
+static double spearmanCorrelation(QVector<double> const& a, QVector<double> const& b) {
+    auto ranks = [](QVector<double> const& values) {
+        QVector<int> order(values.size());
+        for (int i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&values](int x, int y) { return values[x] < values[y]; });
+        QVector<double> result(values.size());
+        for (int begin = 0; begin < order.size();) {
+            int end = begin + 1;
+            while (end < order.size() && values[order[end]] == values[order[begin]]) {
+                ++end;
             }
+            for (int k = begin; k < end; ++k) {
+                result[order[k]] = (begin + end - 1) / 2.0;
+            }
+            begin = end;
         }
+        return result;
+    };
+
+    QVector<double> rankA = ranks(a);
+    QVector<double> rankB = ranks(b);
+    double meanRank       = (a.size() - 1) / 2.0;
+    double covariance     = 0.0;
+    double varianceA      = 0.0;
+    double varianceB      = 0.0;
+    for (int i = 0; i < a.size(); ++i) {
+        covariance += (rankA[i] - meanRank) * (rankB[i] - meanRank);
+        varianceA  += (rankA[i] - meanRank) * (rankA[i] - meanRank);
+        varianceB  += (rankB[i] - meanRank) * (rankB[i] - meanRank);
+    }
+    if (varianceA == 0.0 || varianceB == 0.0) {
+        return 0.0;
+    }
+    return covariance / std::sqrt(varianceA * varianceB);
+}
 
-        // 发送进度更新信号
-        emit autoPlayer->trainingProgress.progressUpdated(gen + 1, generations, bestScore, bestParams);
+// 岛屿之间传递迁移个体的信箱，一个发送者、一个接收者，不加锁
+//
+// 发送和接收都只做一次原子交换：发送者放入新的一批，接收者取走全部。
+// 接收者还没取走的旧一批由发送者释放，接收者只会看到更新的个体。
+class MigrantMailbox {
+   public:
+    MigrantMailbox() = default;
+    MigrantMailbox(MigrantMailbox const&)            = delete;
+    MigrantMailbox& operator=(MigrantMailbox const&) = delete;
+    ~MigrantMailbox() { delete slot.load(); }
+
+    void post(QVector<QVector<double>> const& migrants) {
+        delete slot.exchange(new QVector<QVector<double>>(migrants), std::memory_order_acq_rel);
+    }
 
-        // 创建新一代
-        QVector<QVector<double>> newPopulation;
+    QVector<QVector<double>> take() {
+        std::unique_ptr<QVector<QVector<double>>> migrants(slot.exchange(nullptr, std::memory_order_acq_rel));
+        return migrants ? *migrants : QVector<QVector<double>>();
+    }
 
-        // 精英选择 - 保留最佳的五个个体
-        QVector<int> indices = autoPlayer->findTopIndices(scores, 5);
-        for (int idx : indices) {
-            newPopulation.append(population[idx]);
-        }
+   private:
+    std::atomic<QVector<QVector<double>>*> slot{nullptr};
+};
+
+// 岛屿模型一次训练中各岛共享的状态
+struct IslandRun {
+    int islands;
+    int islandSize;
+    QVector<double> start;
+    quint64 seed;                           // 第 i 个岛使用 FastRandom(seed, i)
+    bool seedWithStart;                     // 是否把 start 放进第0个岛的初始种群
+    std::vector<MigrantMailbox> mailboxes;  // 第 i 个是第 i 个岛的收件箱
+
+    // 以下成员和 TrainingWorker 的评估统计由 mutex 保护，每个岛每代只加锁一次
+    QMutex mutex;
+    QVector<double> bestParams;
+    int bestScore;
+    QVector<int> generationsDone;  // 每个岛已完成的代数
+    int reportedGeneration = 0;    // 所有岛都完成了的代数，已经报告过
+};
+
+double EvaluationStatistics::standardError() const {
+    if (games < 2) {
+        return 0.0;
+    }
+    double average  = mean();
+    double variance = std::max(0.0, (scoreSquareSum - games * average * average) / (games - 1));
+    return std::sqrt(variance / games);
+}
 
-        // 交叉和变异生成新一代
-        while (newPopulation.size() < populationSize) {
-            try {
-                // 选择两个父代进行交叉
-                int parent1 = autoPlayer->tournamentSelection(scores);
-                int parent2 = autoPlayer->tournamentSelection(scores);
+void TrainingWorker::doTraining() {
+    // 初始种群、交叉变异和每个评估任务的对局种子都取自这一个生成器
+    engine2048::FastRandom random = trainingRandom();
 
-                // 确保索引有效
-                if (parent1 < 0 || parent1 >= population.size() || parent2 < 0 || parent2 >= population.size()) {
-                    qDebug() << "Invalid parent index:" << parent1 << parent2;
-                    continue;
-                }
+    QVector<double> bestParams;
+    int bestScore = 0;
 
-                // 交叉
-                QVector<double> child = autoPlayer->crossover(population[parent1], population[parent2]);
+    // 使用当前的最佳参数作为起点
+    bool hasLearnedParams = autoPlayer->useLearnedParams && !autoPlayer->strategyParams.isEmpty();
+    if (hasLearnedParams) {
+        bestParams = autoPlayer->strategyParams;
+        bestScore  = autoPlayer->bestHistoricalScore;
+        qDebug() << "Starting training with existing parameters. Historical best score:" << bestScore;
+    } else {
+        bestParams = QVector<double>(5, 1.0);
+        qDebug() << "Starting training with default parameters.";
+    }
 
-                // 变异 - 增加变异率以提高多样性
-                autoPlayer->mutate(child, 0.3);  // 增加变异率到 30%
+    // 达到目标分数之前评估的参数组数和对局数，-1 表示还没有达到
+    gamesPlayed         = 0;
+    evaluations         = 0;
+    evaluationsToTarget = -1;
+    gamesToTarget       = -1;
+    for (int pair = 0; pair < 3; ++pair) {
+        correlationSums[pair]   = 0.0;
+        correlationCounts[pair] = 0;
+    }
 
-                // 添加到新种群
-                newPopulation.append(child);
-            } catch (std::exception const& e) {
-                qDebug() << "Exception in crossover/mutation:" << e.what();
-                // 出错时创建一个随机个体
-                QVector<double> randomParams(5);
-                // 创建新的随机数生成器
-                std::random_device local_rd;
-                std::mt19937 local_gen(local_rd());
-                std::uniform_real_distribution<> local_dis(0.0, 10.0);
-
-                for (int j = 0; j < 5; ++j) {
-                    randomParams[j] = local_dis(local_gen);  // 生成新的随机参数
-                }
-                newPopulation.append(randomParams);
+    char const* optimizerName = nullptr;
+    bool genetic              = options.optimizer == ParameterTrainingOptions::Optimizer::Genetic;
+    if (options.islands > 1 && genetic) {
+        optimizerName = "island genetic";
+        runIslands(random, bestParams, bestScore);
+    } else if (options.steadyState && genetic) {
+        optimizerName = "steady-state genetic";
+        runSteadyState(initialGeneticPopulation(populationSize, bestParams, autoPlayer->useLearnedParams, random),
+                       random,
+                       bestParams,
+                       bestScore);
+    } else {
+        std::unique_ptr<ParameterOptimizer> optimizer;
+        if (options.optimizer == ParameterTrainingOptions::Optimizer::CmaEs) {
+            // 没有已学习的参数时从遗传算法初始种群的取值范围 [0, 10] 的中心出发
+            if (hasLearnedParams) {
+                optimizer = std::make_unique<CmaEsOptimizer>(populationSize, bestParams, 1.0);
+            } else {
+                optimizer = std::make_unique<CmaEsOptimizer>(populationSize, QVector<double>(5, 5.0), 2.5);
             }
+        } else {
+            optimizer = std::make_unique<GeneticOptimizer>(
+                autoPlayer, populationSize, bestParams, autoPlayer->useLearnedParams, random);
         }
-
-        // 替换旧种群
-        population = newPopulation;
+        optimizerName = optimizer->name();
+        runGenerations(*optimizer, random, bestParams, bestScore);
     }
 
     // 评估最终参数的性能 - 增加模拟次数进行更全面的评估
@@ -220,6 +236,23 @@ void TrainingWorker::doTraining() {
     qDebug() << "Best score in training:" << bestScore;
     qDebug() << "Final evaluation score:" << finalScore;
     qDebug() << "Historical best score:" << autoPlayer->bestHistoricalScore;
+    qDebug() << "Optimizer" << optimizerName << "used" << evaluations << "evaluations," << gamesPlayed << "games";
+    if (options.targetScore > 0) {
+        if (evaluationsToTarget >= 0) {
+            qDebug() << "Evaluations to target score" << options.targetScore << ":" << evaluationsToTarget << "("
+                     << gamesToTarget << "games)";
+        } else {
+            qDebug() << "Target score" << options.targetScore << "was not reached";
+        }
+    }
+    for (int pair = 0; pair < 3; ++pair) {
+        if (correlationCounts[pair] > 0) {
+            qDebug() << "Mean Spearman correlation between search depths" << kFidelityDepths[kFidelityPairs[pair][0]]
+                     << "and" << kFidelityDepths[kFidelityPairs[pair][1]] << ":"
+                     << correlationSums[pair] / correlationCounts[pair] << "over" << correlationCounts[pair]
+                     << "generations";
+        }
+    }
 
     // 只有当新参数比历史最佳参数更好时才更新
     if (finalScore > autoPlayer->bestHistoricalScore) {
@@ -358,7 +391,6 @@ void TrainingWorker::doTraining() {
 
                 // 创建一个新的Auto实例来运行测试，避免与原始实例的冲突
                 Auto testAuto;
-                testAuto.initTables();
                 testAuto.strategyParams = finalBestParams;
                 testAuto.simulateFullGameDetailed(finalBestParams, testScore, maxTile);
 
@@ -434,8 +466,542 @@ void TrainingWorker::doTraining() {
         Qt::QueuedConnection);
 }
 
+// runGenerations: 按代训练
+void TrainingWorker::runGenerations(ParameterOptimizer& optimizer,
+                                    engine2048::FastRandom& random,
+                                    QVector<double>& bestParams,
+                                    int& bestScore) {
+    // 进化多代
+    for (int gen = 0; gen < generations && autoPlayer->trainingActive.load(); ++gen) {
+        QVector<QVector<double>> population = optimizer.ask(random);
+        QVector<int> scores(population.size(), 0);
+        QVector<bool> finalists(population.size(), true);  // 分数可以用来更新最佳参数的个体
+
+        // 共用随机数时本代所有个体的对局种子相同，否则每个个体各取一个
+        quint64 generationSeed = random.next();
+
+        if (options.multiFidelity) {
+            scores = multiFidelityGeneration(population, gen, generationSeed, random);
+        } else if (options.racing) {
+            scores = raceGeneration(population, gen, generationSeed, random, finalists);
+        } else {
+            // 并行评估每个个体，每个任务只写自己的统计，全部完成后才读取分数
+            QVector<quint64> seeds;
+            for (int i = 0; i < population.size(); ++i) {
+                seeds.append(options.commonRandomNumbers ? generationSeed : random.next());
+            }
+            QVector<EvaluationStatistics> results = evaluateCandidates(population, simulations, seeds);
+
+            double bestMean = 0.0;
+            for (int i = 0; i < population.size(); ++i) {
+                scores[i] = static_cast<int>(results[i].mean());
+                bestMean  = std::max(bestMean, results[i].mean());
+            }
+            double progress = static_cast<double>(gen + 1) / generations;
+            emit autoPlayer->trainingProgress.simulationUpdated(
+                simulations, simulations, static_cast<int>(bestMean), qMin(static_cast<int>(progress * 100), 99));
+        }
+
+        // 如果训练已停止，则退出
+        if (!autoPlayer->trainingActive.load()) {
+            break;
+        }
+
+        // 找出本代最佳分数，逐轮淘汰时被淘汰的个体对局太少，不参与
+        int genBestScore = 0;
+
+        for (int i = 0; i < population.size(); ++i) {
+            if (!finalists[i]) {
+                continue;
+            }
+            genBestScore = std::max(genBestScore, scores[i]);
+
+            // 更新全局最佳参数
+            if (scores[i] > bestScore) {
+                bestScore  = scores[i];
+                bestParams = population[i];
+            }
+        }
+
+        countEvaluations(population.size(), genBestScore);
+
+        // 发送进度更新信号
+        emit autoPlayer->trainingProgress.progressUpdated(gen + 1, generations, bestScore, bestParams);
+
+        // 由优化算法产生下一代
+        optimizer.tell(population, scores, random);
+    }
+}
+
+// runSteadyState: 稳态遗传算法训练
+void TrainingWorker::runSteadyState(QVector<QVector<double>> const& initialPopulation,
+                                    engine2048::FastRandom& random,
+                                    QVector<double>& bestParams,
+                                    int& bestScore) {
+    // 与按代训练相同的评估总数，每 populationSize 次评估报告一次进度
+    int budget      = populationSize * generations;
+    int concurrency = std::max(1, QThreadPool::globalInstance()->maxThreadCount());
+
+    // 共用随机数时整个训练只有一组对局，所有个体在同样的对局上比较
+    quint64 sharedSeed = random.next();
+
+    // 评估完成的个体由线程池线程放入队列，训练线程取出后插入种群并立即派发下一个
+    struct Evaluation {
+        QVector<double> params;
+        EvaluationStatistics statistics;
+    };
+    QMutex queueMutex;
+    QWaitCondition evaluationFinished;
+    QVector<Evaluation> finished;
+
+    SteadyStatePopulation population(autoPlayer, populationSize);
+    QVector<QVector<double>> pending = initialPopulation;
+    int dispatched                   = 0;
+    int completed                    = 0;
+    int inFlight                     = 0;
+
+    while (true) {
+        // 让每个线程都有一个个体在评估；初始个体派发完之前种群可能还是空的，这时只能等待
+        while (autoPlayer->trainingActive.load() && inFlight < concurrency && dispatched < budget
+               && !(pending.isEmpty() && population.isEmpty())) {
+            QVector<double> params = pending.isEmpty() ? population.breed(random) : pending.takeFirst();
+            quint64 seed           = options.commonRandomNumbers ? sharedSeed : random.next();
+            int games              = simulations;
+
+            auto* task = new FunctionTask([&queueMutex, &evaluationFinished, &finished, params, games, seed]() {
+                Evaluation evaluation = {params, EvaluationStatistics()};
+                simulateOnThread(params, games, seed, -1, [&evaluation](int score) {
+                    evaluation.statistics.add(score);
+                });
+                QMutexLocker locker(&queueMutex);
+                finished.append(evaluation);
+                evaluationFinished.wakeOne();
+            });
+            task->setAutoDelete(true);
+            QThreadPool::globalInstance()->start(task);
+            dispatched++;
+            inFlight++;
+        }
+
+        // 没有在评估的个体说明预算用完或训练已停止
+        if (inFlight == 0) {
+            break;
+        }
+
+        Evaluation evaluation;
+        {
+            QMutexLocker locker(&queueMutex);
+            while (finished.isEmpty()) {
+                evaluationFinished.wait(&queueMutex);
+            }
+            evaluation = finished.takeFirst();
+        }
+        inFlight--;
+        completed++;
+        gamesPlayed += evaluation.statistics.games;
+
+        // 停止后只等待已派发的评估结束，不再使用它们的结果
+        if (!autoPlayer->trainingActive.load()) {
+            continue;
+        }
+
+        int score = static_cast<int>(evaluation.statistics.mean());
+        population.insert(evaluation.params, score);
+        countEvaluations(1, score);
+        if (score > bestScore) {
+            bestScore  = score;
+            bestParams = evaluation.params;
+        }
+
+        int progress = qMin(completed * 100 / budget, 99);
+        emit autoPlayer->trainingProgress.simulationUpdated(completed, budget, score, progress);
+        if (completed % populationSize == 0) {
+            emit autoPlayer->trainingProgress.progressUpdated(
+                completed / populationSize, generations, bestScore, bestParams);
+        }
+    }
+}
+
+// runIslands: 岛屿模型训练
+void TrainingWorker::runIslands(engine2048::FastRandom& random, QVector<double>& bestParams, int& bestScore) {
+    // 每个岛占一个线程，岛数不超过线程数，否则后面的岛要等前面的岛结束才开始
+    IslandRun run;
+    run.islands         = std::min(options.islands, std::max(1, QThreadPool::globalInstance()->maxThreadCount()));
+    run.islandSize      = std::max(kMinIslandPopulation, populationSize / run.islands);
+    run.seed            = random.next();
+    run.start           = bestParams;
+    run.seedWithStart   = autoPlayer->useLearnedParams;
+    run.mailboxes       = std::vector<MigrantMailbox>(run.islands);
+    run.bestParams      = bestParams;
+    run.bestScore       = bestScore;
+    run.generationsDone = QVector<int>(run.islands, 0);
+    qDebug() << "Island model:" << run.islands << "islands of" << run.islandSize << "sets, migrating every"
+             << options.migrationInterval << "generations";
+
+    for (int island = 0; island < run.islands; ++island) {
+        auto* task = new FunctionTask([this, island, &run]() { runIsland(island, run); });
+        task->setAutoDelete(true);
+        QThreadPool::globalInstance()->start(task);
+    }
+    QThreadPool::globalInstance()->waitForDone();
+
+    bestParams = run.bestParams;
+    bestScore  = run.bestScore;
+}
+
+// runIsland: 一个岛的进化循环
+void TrainingWorker::runIsland(int island, IslandRun& run) {
+    engine2048::FastRandom random(run.seed, static_cast<quint64>(island));
+    GeneticOptimizer optimizer(autoPlayer, run.islandSize, run.start, run.seedWithStart && island == 0, random);
+
+    for (int gen = 0; gen < generations && autoPlayer->trainingActive.load(); ++gen) {
+        QVector<QVector<double>> population = optimizer.ask(random);
+
+        // 迁入的个体替换排在最后的子代，排在前面的精英不受影响
+        QVector<QVector<double>> migrants = run.mailboxes[island].take();
+        for (int k = 0; k < migrants.size() && k < population.size(); ++k) {
+            population[population.size() - 1 - k] = migrants[k];
+        }
+
+        // 在本线程上依次评估，共用随机数时同一岛同一代的个体用同一个种子
+        quint64 generationSeed = random.next();
+        QVector<int> scores(population.size(), 0);
+        qint64 games = 0;
+        for (int i = 0; i < population.size() && autoPlayer->trainingActive.load(); ++i) {
+            EvaluationStatistics statistics;
+            quint64 seed = options.commonRandomNumbers ? generationSeed : random.next();
+            simulateOnThread(population[i], simulations, seed, -1, [&statistics](int score) {
+                statistics.add(score);
+            });
+            scores[i]  = static_cast<int>(statistics.mean());
+            games     += statistics.games;
+        }
+        if (!autoPlayer->trainingActive.load()) {
+            break;
+        }
+
+        // 每 migrationInterval 代把最好的几个个体发给环上的下一个岛
+        if ((gen + 1) % std::max(1, options.migrationInterval) == 0) {
+            QVector<QVector<double>> emigrants;
+            for (int index : autoPlayer->findTopIndices(scores, kMigrants)) {
+                emigrants.append(population[index]);
+            }
+            run.mailboxes[(island + 1) % run.islands].post(emigrants);
+        }
+
+        int genBest = static_cast<int>(std::max_element(scores.begin(), scores.end()) - scores.begin());
+        {
+            QMutexLocker locker(&run.mutex);
+            gamesPlayed += games;
+            countEvaluations(population.size(), scores[genBest]);
+            if (scores[genBest] > run.bestScore) {
+                run.bestScore  = scores[genBest];
+                run.bestParams = population[genBest];
+            }
+
+            // 所有岛都完成第 n 代后才报告第 n 代
+            run.generationsDone[island] = gen + 1;
+            int totalDone               = 0;
+            int slowest                 = generations;
+            for (int done : run.generationsDone) {
+                totalDone += done;
+                slowest    = std::min(slowest, done);
+            }
+            int progress = qMin(totalDone * 100 / (run.islands * generations), 99);
+            emit autoPlayer->trainingProgress.simulationUpdated(
+                totalDone, run.islands * generations, scores[genBest], progress);
+            if (slowest > run.reportedGeneration) {
+                run.reportedGeneration = slowest;
+                emit autoPlayer->trainingProgress.progressUpdated(
+                    slowest, generations, run.bestScore, run.bestParams);
+            }
+        }
+
+        optimizer.tell(population, scores, random);
+    }
+}
+
+// countEvaluations: 统计评估次数并检查是否达到目标分数
+void TrainingWorker::countEvaluations(int count, int bestBatchScore) {
+    evaluations += count;
+
+    // 本次训练中第一次有参数组达到目标分数
+    if (options.targetScore > 0 && evaluationsToTarget < 0 && bestBatchScore >= options.targetScore) {
+        evaluationsToTarget = evaluations;
+        gamesToTarget       = gamesPlayed;
+        qDebug() << "Reached target score" << options.targetScore << "after" << evaluationsToTarget
+                 << "evaluations," << gamesToTarget << "games";
+    }
+}
+
+// evaluateCandidates: 并行评估多组参数
+QVector<EvaluationStatistics> TrainingWorker::evaluateCandidates(QVector<QVector<double>> const& candidates,
+                                                                 int games,
+                                                                 QVector<quint64> const& seeds,
+                                                                 int searchDepth) {
+    // 每个任务只写自己的槽位，waitForDone 返回后在本线程读取
+    QVector<EvaluationStatistics> results(candidates.size());
+    for (int i = 0; i < candidates.size(); ++i) {
+        EvaluationStatistics* result = &results[i];
+        QVector<double> params       = candidates[i];
+        quint64 seed                 = seeds[i];
+        auto* task                   = new FunctionTask([result, params, games, seed, searchDepth]() {
+            simulateOnThread(params, games, seed, searchDepth, [result](int score) { result->add(score); });
+        });
+        task->setAutoDelete(true);
+        QThreadPool::globalInstance()->start(task);
+    }
+    QThreadPool::globalInstance()->waitForDone();
+    gamesPlayed += static_cast<qint64>(candidates.size()) * games;
+    return results;
+}
+
+// raceGeneration: 逐轮淘汰地评估一代
+QVector<int> TrainingWorker::raceGeneration(QVector<QVector<double>> const& population,
+                                            int generation,
+                                            quint64 generationSeed,
+                                            engine2048::FastRandom& random,
+                                            QVector<bool>& finalists) {
+    QVector<EvaluationStatistics> statistics(population.size());
+    QVector<int> survivors;
+    for (int i = 0; i < population.size(); ++i) {
+        survivors.append(i);
+    }
+
+    int initialGames = std::max(2, simulations / kRaceInitialFraction);
+    int played       = 0;  // 当前幸存者每人已下的局数
+    int totalGames   = 0;
+    for (int round = 0; autoPlayer->trainingActive.load(); ++round) {
+        // 本轮把幸存者的累计对局数补到 initialGames << round，最多 simulations
+        int target = std::min(simulations, initialGames << std::min(round, 16));
+        int games  = target - played;
+
+        // 共用随机数时同一轮所有幸存者用同一个种子，不同轮的对局不重复
+        quint64 roundSeed = engine2048::FastRandom(generationSeed, static_cast<quint64>(round)).next();
+        QVector<QVector<double>> candidates;
+        QVector<quint64> seeds;
+        for (int index : survivors) {
+            candidates.append(population[index]);
+            seeds.append(options.commonRandomNumbers ? roundSeed : random.next());
+        }
+        QVector<EvaluationStatistics> results = evaluateCandidates(candidates, games, seeds);
+        for (int k = 0; k < survivors.size(); ++k) {
+            statistics[survivors[k]].merge(results[k]);
+        }
+        played     += games;
+        totalGames += games * static_cast<int>(survivors.size());
+
+        // 报告目前最好的平均分，进度按本代已完成的轮次估计
+        double bestMean = 0.0;
+        for (int index : survivors) {
+            bestMean = std::max(bestMean, statistics[index].mean());
+        }
+        double progress = (generation + static_cast<double>(played) / simulations) / generations;
+        emit autoPlayer->trainingProgress.simulationUpdated(
+            played, simulations, static_cast<int>(bestMean), qMin(static_cast<int>(progress * 100), 99));
+
+        if (played >= simulations) {
+            break;
+        }
+        if (survivors.size() <= kRaceFinalists) {
+            continue;
+        }
+
+        // 按平均分排序，保留前一半（至少 kRaceFinalists 个），排在后面的个体如果置信区间
+        // 与保留的最后一名重叠（相差不到一个标准误差之和）也留下
+        std::sort(survivors.begin(), survivors.end(), [&statistics](int a, int b) {
+            return statistics[a].mean() > statistics[b].mean();
+        });
+        int keep                           = std::max(kRaceFinalists, static_cast<int>(survivors.size() + 1) / 2);
+        EvaluationStatistics const& cutoff = statistics[survivors[keep - 1]];
+        double lowerBound                  = cutoff.mean() - cutoff.standardError();
+        QVector<int> next                  = survivors.mid(0, keep);
+        for (int k = keep; k < survivors.size(); ++k) {
+            EvaluationStatistics const& candidate = statistics[survivors[k]];
+            if (candidate.mean() + candidate.standardError() >= lowerBound) {
+                next.append(survivors[k]);
+            }
+        }
+        survivors = next;
+    }
+
+    qDebug() << "Racing evaluation used" << totalGames << "games instead of" << population.size() * simulations;
+
+    // 下的局数越多说明留到越后面：按局数从多到少处理，被淘汰的个体的分数压到比所有晚于它淘汰的个体都低，
+    // 对局少、噪声大的平均分不会排到留下来的个体前面
+    QVector<int> order;
+    for (int i = 0; i < population.size(); ++i) {
+        order.append(i);
+        finalists[i] = false;
+    }
+    std::sort(order.begin(), order.end(), [&statistics](int a, int b) {
+        return statistics[a].games > statistics[b].games;
+    });
+
+    QVector<int> scores(population.size());
+    double ceiling    = std::numeric_limits<double>::infinity();
+    double groupFloor = ceiling;
+    int groupGames    = -1;
+    for (int index : order) {
+        if (statistics[index].games != groupGames) {
+            ceiling    = groupFloor;
+            groupGames = statistics[index].games;
+        }
+        double score  = std::min(statistics[index].mean(), ceiling - 1);
+        scores[index] = static_cast<int>(std::max(score, 0.0));
+        groupFloor    = std::min(groupFloor, score);
+    }
+    for (int index : survivors) {
+        finalists[index] = true;
+    }
+    return scores;
+}
+
+// multiFidelityGeneration: 多精度地评估一代
+QVector<int> TrainingWorker::multiFidelityGeneration(QVector<QVector<double>> const& population,
+                                                     int generation,
+                                                     quint64 generationSeed,
+                                                     engine2048::FastRandom& random) {
+    // levelScores[l][i] 为第 i 个个体在第 l 层的平均分，没有评估到这一层时为 -1
+    QVector<QVector<double>> levelScores(kFidelityLevels, QVector<double>(population.size(), -1.0));
+    QVector<int> survivors;
+    for (int i = 0; i < population.size(); ++i) {
+        survivors.append(i);
+    }
+
+    for (int level = 0; level < kFidelityLevels && autoPlayer->trainingActive.load(); ++level) {
+        // 之后每层只评估上一层排在前一半的个体，最后一层只留 kRaceFinalists 个
+        if (level > 0) {
+            QVector<double> const& previous = levelScores[level - 1];
+            std::sort(survivors.begin(), survivors.end(), [&previous](int a, int b) {
+                return previous[a] > previous[b];
+            });
+            int keep = std::max(kRaceFinalists, static_cast<int>(survivors.size() + 1) / 2);
+            if (level == kFidelityLevels - 1) {
+                keep = kRaceFinalists;
+            }
+            survivors = survivors.mid(0, keep);
+        }
+
+        // 共用随机数时同一层所有个体用同一个种子
+        quint64 levelSeed = engine2048::FastRandom(generationSeed, static_cast<quint64>(level)).next();
+        QVector<QVector<double>> candidates;
+        QVector<quint64> seeds;
+        for (int index : survivors) {
+            candidates.append(population[index]);
+            seeds.append(options.commonRandomNumbers ? levelSeed : random.next());
+        }
+        QVector<EvaluationStatistics> results =
+            evaluateCandidates(candidates, simulations, seeds, kFidelityDepths[level]);
+
+        double bestMean = 0.0;
+        for (int k = 0; k < survivors.size(); ++k) {
+            levelScores[level][survivors[k]] = results[k].mean();
+            bestMean                         = std::max(bestMean, results[k].mean());
+        }
+        double progress = (generation + static_cast<double>(level + 1) / kFidelityLevels) / generations;
+        emit autoPlayer->trainingProgress.simulationUpdated(
+            level + 1, kFidelityLevels, static_cast<int>(bestMean), qMin(static_cast<int>(progress * 100), 99));
+    }
+
+    // 在两层都评估过的个体上计算排名相关；只包含晋级的个体，范围受限，会比在全体上计算的偏低
+    for (int pair = 0; pair < 3; ++pair) {
+        QVector<double> low;
+        QVector<double> high;
+        for (int i = 0; i < population.size(); ++i) {
+            if (levelScores[kFidelityPairs[pair][1]][i] >= 0) {
+                low.append(levelScores[kFidelityPairs[pair][0]][i]);
+                high.append(levelScores[kFidelityPairs[pair][1]][i]);
+            }
+        }
+        if (low.size() < 3) {
+            continue;
+        }
+        double correlation = spearmanCorrelation(low, high);
+        correlationSums[pair] += correlation;
+        correlationCounts[pair]++;
+        qDebug() << "Generation" << generation + 1 << "Spearman correlation between search depths"
+                 << kFidelityDepths[kFidelityPairs[pair][0]] << "and" << kFidelityDepths[kFidelityPairs[pair][1]]
+                 << "over" << low.size() << "sets:" << correlation;
+    }
+
+    // 不同层的分数不能直接比较：每个个体取评估到的最高层的分数，但压到比晋级到更高层的个体都低
+    QVector<int> scores(population.size(), 0);
+    double ceiling = std::numeric_limits<double>::infinity();
+    for (int level = kFidelityLevels - 1; level >= 0; --level) {
+        double levelFloor = ceiling;
+        for (int i = 0; i < population.size(); ++i) {
+            bool evaluated = levelScores[level][i] >= 0;
+            bool promoted  = level < kFidelityLevels - 1 && levelScores[level + 1][i] >= 0;
+            if (evaluated && !promoted) {
+                double score = std::min(levelScores[level][i], ceiling - 1);
+                scores[i]    = static_cast<int>(std::max(score, 0.0));
+                levelFloor   = std::min(levelFloor, score);
+            }
+        }
+        ceiling = levelFloor;
+    }
+    return scores;
+}
+
 // 安全发出完成信号
 void TrainingWorker::emitFinished() {
     // 发出完成信号
     emit finished();
 }
+
+// 时间差分训练：在全部核心上自我对弈，训练结束后保存权重并交给搜索使用
+void TdTrainingWorker::doTraining() {
+    QString weightsPath = autoPlayer->ntupleWeightsPath();
+
+    // 已有权重时在其基础上继续训练
+    std::shared_ptr<engine2048::NTupleNetwork> network = engine2048::NTupleNetwork::load(weightsPath.toStdString());
+    if (network) {
+        qDebug() << "Continuing TD training from" << weightsPath;
+    } else {
+        network = std::make_shared<engine2048::NTupleNetwork>();
+        qDebug() << "Starting TD training from zero weights";
+    }
+
+    engine2048::TdTrainer trainer(network);
+    engine2048::TdTrainer::Options options;
+    options.learningRate = learningRate;
+    options.lambda       = lambda;
+    options.seed         = trainingRandom().next();
+
+    // 复用遗传算法的进度信号：simulationUpdated 报告局数和平均分，
+    // progressUpdated 的第 n 次报告附带 {每秒局数, 平均分, 最大方块}
+    int reportCount = 0;
+    int lastAverage = 0;
+    auto report     = [this, &reportCount, &lastAverage](engine2048::TdTrainer::Progress const& progress) {
+        int percent = games > 0 ? static_cast<int>(qMin<quint64>(99, progress.games * 100 / games)) : 0;
+        if (progress.averageScore > 0) {
+            lastAverage = static_cast<int>(progress.averageScore);
+        }
+        emit autoPlayer->trainingProgress.simulationUpdated(
+            static_cast<int>(progress.games), static_cast<int>(games), lastAverage, percent);
+        QVector<double> statistics = {
+            progress.gamesPerSecond, progress.averageScore, static_cast<double>(progress.maxTile)};
+        emit autoPlayer->trainingProgress.progressUpdated(++reportCount, 0, lastAverage, statistics);
+        qDebug() << "TD training -" << progress.games << "games," << progress.gamesPerSecond << "games/s,"
+                 << "average score" << progress.averageScore << "max tile" << progress.maxTile;
+        return autoPlayer->trainingActive.load();
+    };
+    quint64 gamesPlayed = trainer.train(games, options, report);
+
+    // 保存权重，并让之后的位棋盘搜索使用新网络
+    QDir().mkpath(QFileInfo(weightsPath).absolutePath());
+    if (network->save(weightsPath.toStdString())) {
+        qDebug() << "Saved n-tuple weights to" << weightsPath << "after" << gamesPlayed << "games";
+    } else {
+        qDebug() << "Failed to save n-tuple weights to" << weightsPath;
+    }
+    {
+        QMutexLocker locker(&autoPlayer->searcherMutex);
+        autoPlayer->ntupleNetwork = network;
+    }
+
+    autoPlayer->trainingActive.store(false);
+    emit autoPlayer->trainingProgress.trainingCompleted(lastAverage, {});
+    emit finished();
+}
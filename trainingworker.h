@@ -3,16 +3,91 @@
 
 #include <QObject>
 #include <QVector>
+#include <QtGlobal>
 
 class Auto;
+class ParameterOptimizer;
+struct IslandRun;
+
+namespace engine2048 {
+class FastRandom;
+}
+
+// 启发式参数训练的可选设置
+struct ParameterTrainingOptions {
+    enum class Optimizer {
+        Genetic,  // 遗传算法
+        CmaEs,    // CMA-ES
+    };
+    Optimizer optimizer = Optimizer::Genetic;
+
+    // 同一代的所有个体下同一组种子的对局：比较个体时新方块的随机性大部分相互抵消，
+    // 用更少的对局就能得到同样可靠的排序。逐轮淘汰时每一轮、多精度评估时每一层各用一个共同种子。
+    // 分数都在本代的对局全部结束后才读取，不会用到不完整的配对
+    bool commonRandomNumbers = false;
+
+    // 逐轮淘汰（successive halving）：每代先让所有个体各下少量对局，淘汰排名靠后且置信区间
+    // 与留下的个体不重叠的一半，剩下的个体对局数翻倍，直到最后几个个体下满 simulations 局
+    bool racing = false;
+
+    // 多精度评估：每代先用一步贪心走子评估所有个体，排在前一半的再用两层搜索评估，
+    // 最后几个个体才用实际对局的搜索深度评估，并报告相邻精度之间排名的 Spearman 相关系数。
+    // 优先于逐轮淘汰，只用于按代训练
+    bool multiFidelity = false;
+
+    // 稳态遗传算法：不再按代等待整代评估完，每个线程评估完一个个体就插入种群并立即繁殖、派发下一个，
+    // 所有线程一直有活做。评估总数与按代训练相同；不使用逐轮淘汰，只对遗传算法有效
+    bool steadyState = false;
+
+    // 岛屿模型：种群分成 islands 个子种群，各自在一个线程上独立进化，每 migrationInterval 代
+    // 把最好的几个个体发给环上的下一个岛。为1时不分岛；只对遗传算法有效，不与稳态和逐轮淘汰同时使用
+    int islands           = 1;
+    int migrationInterval = 5;
+
+    // 目前最好的平均分第一次达到这个分数时，记录已经评估了多少组参数、下了多少局，0 表示不设目标。
+    // 用来比较不同优化算法得到同样好的参数所需的计算量
+    int targetScore = 0;
+};
+
+// 一组参数的对局分数统计，用于计算平均分和标准误差
+struct EvaluationStatistics {
+    int games             = 0;
+    double scoreSum       = 0.0;
+    double scoreSquareSum = 0.0;
+
+    void add(int score) {
+        games++;
+        scoreSum       += score;
+        scoreSquareSum += static_cast<double>(score) * score;
+    }
+
+    void merge(EvaluationStatistics const& other) {
+        games          += other.games;
+        scoreSum       += other.scoreSum;
+        scoreSquareSum += other.scoreSquareSum;
+    }
+
+    double mean() const { return games > 0 ? scoreSum / games : 0.0; }
+
+    // 平均分的标准误差，少于两局时为0
+    double standardError() const;
+};
 
 // 训练工作线程类
 class TrainingWorker : public QObject {
     Q_OBJECT
 
    public:
-    TrainingWorker(Auto* autoPlayer, int populationSize, int generations, int simulations)
-        : autoPlayer(autoPlayer), populationSize(populationSize), generations(generations), simulations(simulations) {}
+    TrainingWorker(Auto* autoPlayer,
+                   int populationSize,
+                   int generations,
+                   int simulations,
+                   ParameterTrainingOptions const& options = {})
+        : autoPlayer(autoPlayer),
+          populationSize(populationSize),
+          generations(generations),
+          simulations(simulations),
+          options(options) {}
 
    public slots:
     void doTraining();
@@ -22,10 +97,84 @@ class TrainingWorker : public QObject {
     void finished();
 
    private:
+    // 按代训练：每代由 optimizer 给出一组参数，全部评估完后交还分数
+    void runGenerations(ParameterOptimizer& optimizer,
+                        engine2048::FastRandom& random,
+                        QVector<double>& bestParams,
+                        int& bestScore);
+
+    // 稳态遗传算法训练，先评估 initialPopulation，之后每完成一次评估就派发一个新繁殖的个体
+    void runSteadyState(QVector<QVector<double>> const& initialPopulation,
+                        engine2048::FastRandom& random,
+                        QVector<double>& bestParams,
+                        int& bestScore);
+
+    // 岛屿模型训练，每个岛在线程池的一个线程上运行 runIsland，全部结束后返回
+    void runIslands(engine2048::FastRandom& random, QVector<double>& bestParams, int& bestScore);
+
+    // 第 island 个岛的进化循环，在本线程上依次评估自己的子种群
+    void runIsland(int island, IslandRun& run);
+
+    // 记录完成了 count 次评估，其中最好的平均分为 bestBatchScore，第一次达到目标分数时记下计算量
+    void countEvaluations(int count, int bestBatchScore);
+
+    // 在全局线程池上同时评估多组参数，第 i 组用种子 seeds[i] 下 games 局，阻塞直到全部完成
+    // searchDepth 为 -1 时用训练的自我对弈，否则用搜索 searchDepth 层的对局
+    QVector<EvaluationStatistics> evaluateCandidates(QVector<QVector<double>> const& candidates,
+                                                     int games,
+                                                     QVector<quint64> const& seeds,
+                                                     int searchDepth = -1);
+
+    // 逐轮淘汰地评估一代，返回每个个体的平均分，被淘汰的个体的分数压到比所有晚于它淘汰的个体都低，
+    // 因此淘汰的顺序与分数的排序一致；finalists 标出留到最后的个体，只有它们的分数用来更新最佳参数
+    QVector<int> raceGeneration(QVector<QVector<double>> const& population,
+                                int generation,
+                                quint64 generationSeed,
+                                engine2048::FastRandom& random,
+                                QVector<bool>& finalists);
+
+    // 多精度地评估一代，返回每个个体在它评估到的最高精度上的平均分，晋级的个体总是排在未晋级的前面
+    QVector<int> multiFidelityGeneration(QVector<QVector<double>> const& population,
+                                         int generation,
+                                         quint64 generationSeed,
+                                         engine2048::FastRandom& random);
+
     Auto* autoPlayer;
     int populationSize;
     int generations;
     int simulations;
+    ParameterTrainingOptions options;
+
+    // 本次训练已经评估的参数组数和下的对局数，以及第一次达到目标分数时的这两个值（-1 表示还没有达到）
+    int evaluations         = 0;
+    qint64 gamesPlayed      = 0;
+    int evaluationsToTarget = -1;
+    qint64 gamesToTarget    = -1;
+
+    // 多精度评估中各对精度之间的 Spearman 相关系数之和与代数，训练结束时报告平均值
+    double correlationSums[3] = {};
+    int correlationCounts[3]  = {};
+};
+
+// N元组网络的时间差分自我对弈训练线程类
+class TdTrainingWorker : public QObject {
+    Q_OBJECT
+
+   public:
+    TdTrainingWorker(Auto* autoPlayer, quint64 games, double learningRate, double lambda)
+        : autoPlayer(autoPlayer), games(games), learningRate(learningRate), lambda(lambda) {}
+
+   public slots:
+    void doTraining();
+
+   signals:
+    void finished();
+
+   private:
+    Auto* autoPlayer;
+    quint64 games;
+    double learningRate;
+    double lambda;
 };
 
 #endif  // TRAININGWORKER_H